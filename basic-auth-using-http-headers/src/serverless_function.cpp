@@ -2,6 +2,7 @@
 #include <string>
 #include <vector>
 #include <map>
+#include <optional>
 
 #include <edjx/error.hpp>
 #include <edjx/request.hpp>
@@ -9,6 +10,8 @@
 #include <edjx/logger.hpp>
 #include <edjx/http.hpp>
 
+#include <edjsamples/headers.hpp>
+
 using edjx::http::HttpHeaders;
 using edjx::http::HttpStatusCode;
 using edjx::request::HttpRequest;
@@ -16,6 +19,7 @@ using edjx::response::HttpResponse;
 using edjx::error::HttpError;
 using edjx::logger::error;
 using edjx::logger::info;
+using edjsamples::headers::HeaderIndex;
 
 static const HttpStatusCode HTTP_STATUS_OK = 200;
 static const HttpStatusCode HTTP_STATUS_UNAUTHORIZED = 401;
@@ -28,27 +32,17 @@ bool verify_auth_token(const std::string & _token) {
 HttpResponse serverless(const HttpRequest & req) {
     info("**Basic Auth using http headers function**");
 
-    // Get "Authorization" header value (Note: case-sensitive!)
+    // Get "Authorization" header value (header names are case-insensitive)
     const HttpHeaders & headers = req.get_headers();
-    HttpHeaders::const_iterator auth_header_iterator = headers.find("authorization");
-    if (auth_header_iterator == headers.end()) {
+    HeaderIndex header_index(headers);
+    std::optional<std::string> auth_header_value = header_index.joined("Authorization");
+    if (!auth_header_value.has_value()) {
         return HttpResponse("Authentication Error : No token present")
             .set_status(HTTP_STATUS_UNAUTHORIZED);
     }
 
-    // Create a single comma-separated string of values from std::vector<std::string>
-    std::string auth_header_value;
-    bool auth_header_first_value = true;
-    for (const auto & value : auth_header_iterator->second) {
-        if (!auth_header_first_value) {
-            auth_header_value += ",";
-        }
-        auth_header_value += value;
-        auth_header_first_value = false;
-    }
-
     // Verify authorization token
-    if (!verify_auth_token(auth_header_value)) {
+    if (!verify_auth_token(auth_header_value.value())) {
         return HttpResponse("Authentication Error : Invalid auth token")
             .set_status(HTTP_STATUS_UNAUTHORIZED);
     }
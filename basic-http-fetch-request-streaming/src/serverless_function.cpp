@@ -1,5 +1,6 @@
 #include <cstdint>
 #include <string>
+#include <string_view>
 #include <vector>
 
 #include <edjx/logger.hpp>
@@ -11,6 +12,8 @@
 #include <edjx/utils.hpp>
 #include <edjx/stream.hpp>
 
+#include <edjsamples/stream.hpp>
+
 using edjx::logger::info;
 using edjx::logger::error;
 using edjx::error::HttpError;
@@ -24,6 +27,7 @@ using edjx::fetch::HttpFetch;
 using edjx::fetch::FetchResponse;
 using edjx::fetch::FetchResponsePending;
 using edjx::stream::WriteStream;
+using edjsamples::stream::BufferedWriteStream;
 
 static const HttpStatusCode HTTP_STATUS_OK = 200;
 static const HttpStatusCode HTTP_STATUS_INTERNAL_SERVER_ERROR = 500;
@@ -51,11 +55,14 @@ HttpResponse serverless(const HttpRequest & req) {
     std::string content = "WHERE IS THE EDGE, ANYWAY?\nIf you ask a cloud company, they tell you the edge is their multi-billion dollar collection of server farms. A content delivery network (CDN) provider says it's their hundreds of points of presence. Wireless carriers will try to convince you it's their tens of thousands of macrocell and picocell sites.\n\nAt EDJX, we say the edge is anywhere and everywhere, a thousand feet away from you at all times. We believe computing needs to become ubiquitous, like electricity, to power billions of connected devices.\nThe edge will go so far out into the woods, you can hear the sasquatch scream.";
     bool stream_success = true;
 
+    // Small chunks are coalesced, so the host is called once per
+    // BufferedWriteStream::DEFAULT_FLUSH_THRESHOLD bytes instead of once per chunk
+    BufferedWriteStream buffered_stream(write_stream);
+
     // Send chunks of increasing sizes (1, 2, 3, ...)
     for (int i = 0, len = 1; i < content.length(); i += len, len++) {
-        // Alternate between sending chunks as text and as bytes
-        std::string chunk = content.substr(i, len);
-        StreamError err = write_stream.write_chunk(chunk);
+        std::string_view chunk = std::string_view(content).substr(i, len);
+        StreamError err = buffered_stream.write(chunk);
         if (err != StreamError::Success) {
             error("Error when writing a text chunk: " + to_string(err));
             stream_success = false;
@@ -66,14 +73,14 @@ HttpResponse serverless(const HttpRequest & req) {
     // Close the stream
     if (stream_success) {
         // No error encountered - cleanly close the stream
-        StreamError close_err = write_stream.close();
+        StreamError close_err = buffered_stream.close();
         if (close_err != StreamError::Success) {
             error("Error when closing a stream: " + to_string(close_err));
             stream_success = false;
         }
     } else {
         // There was an error - abort the stream
-        StreamError close_err = write_stream.abort();
+        StreamError close_err = buffered_stream.abort();
         if (close_err != StreamError::Success) {
             error("Error when aborting a stream: " + to_string(close_err));
             stream_success = false;
@@ -1,5 +1,7 @@
 #include <cstdint>
+#include <optional>
 #include <string>
+#include <string_view>
 #include <vector>
 
 #include <edjx/logger.hpp>
@@ -11,6 +13,11 @@
 #include <edjx/utils.hpp>
 #include <edjx/stream.hpp>
 
+#include <edjsamples/ascii.hpp>
+#include <edjsamples/compress.hpp>
+#include <edjsamples/headers.hpp>
+#include <edjsamples/stream.hpp>
+
 using edjx::logger::info;
 using edjx::logger::error;
 using edjx::error::HttpError;
@@ -24,10 +31,66 @@ using edjx::fetch::HttpFetch;
 using edjx::fetch::FetchResponse;
 using edjx::stream::ReadStream;
 using edjx::stream::WriteStream;
+using edjsamples::compress::CompressWriteStream;
+using edjsamples::compress::Encoding;
+using edjsamples::headers::HeaderIndex;
+using edjsamples::stream::ByteSpan;
+using edjsamples::stream::ChunkPool;
+using edjsamples::stream::ChunkReader;
 
 static const HttpStatusCode HTTP_STATUS_OK = 200;
 static const HttpStatusCode HTTP_STATUS_INTERNAL_SERVER_ERROR = 500;
 
+// Capacity of the chunk buffers, allocated once per request
+static const size_t CHUNK_CAPACITY = 64 * 1024;
+
+// zlib compression level of the response (1 = fastest, 9 = smallest), see
+// bench/micro/src/compress_bench.cpp
+static const int COMPRESSION_LEVEL = 4;
+
+// Coding of the response: the fetched content is compressed if the client
+// accepts gzip or deflate and the origin did not encode it already
+static Encoding response_encoding(const HttpRequest & req, const FetchResponse & fetch_res) {
+    std::optional<std::string_view> content_encoding = HeaderIndex(fetch_res.get_headers()).first("content-encoding");
+    if (content_encoding.has_value()
+        && !edjsamples::ascii::equal_nocase(edjsamples::ascii::trim(content_encoding.value()), "identity")) {
+        return Encoding::Identity;
+    }
+    std::optional<std::string_view> accept_encoding = HeaderIndex(req.get_headers()).first("accept-encoding");
+    if (!accept_encoding.has_value()) {
+        return Encoding::Identity;
+    }
+    return edjsamples::compress::negotiate(accept_encoding.value());
+}
+
+// Compresses the chunks of `read_stream` into `write_stream` and closes both
+static StreamError compress_stream(ReadStream & read_stream, WriteStream & write_stream, Encoding encoding) {
+    ChunkPool pool(2, CHUNK_CAPACITY);
+    CompressWriteStream compressor(write_stream, pool, encoding, COMPRESSION_LEVEL);
+    ChunkReader reader(read_stream, pool);
+    ByteSpan chunk;
+    StreamError read_err;
+    while ((read_err = reader.read(chunk)) == StreamError::Success) {
+        StreamError write_err = compressor.write(chunk);
+        if (write_err != StreamError::Success) {
+            read_stream.close();
+            compressor.abort();
+            return write_err;
+        }
+    }
+    read_stream.close();
+    if (read_err != StreamError::EndOfStream) {
+        compressor.abort();
+        return read_err;
+    }
+    StreamError close_err = compressor.close();
+    if (close_err == StreamError::Success) {
+        info("Compressed " + std::to_string(compressor.bytes_in()) + " bytes to "
+            + std::to_string(compressor.bytes_out()) + " bytes");
+    }
+    return close_err;
+}
+
 inline std::vector<uint8_t> to_bytes(const std::string & str) {
     std::vector<uint8_t> bytes;
     for (auto c : str) {
@@ -56,9 +119,14 @@ bool serverless_streaming(HttpRequest & req) {
     ReadStream read_stream = fetch_res.get_read_stream();
 
     // Prepare an HTTP response
+    Encoding encoding = response_encoding(req, fetch_res);
     HttpResponse res;
     res.set_status(HTTP_STATUS_OK);
     res.set_header("Serverless", "EDJX");
+    res.set_header("Vary", "Accept-Encoding");
+    if (encoding != Encoding::Identity) {
+        res.set_header("Content-Encoding", std::string(edjsamples::compress::to_string(encoding)));
+    }
 
     // Open a write stream for the HTTP response
     WriteStream write_stream;
@@ -69,6 +137,17 @@ bool serverless_streaming(HttpRequest & req) {
         return false;
     }
 
+    // Compress the fetch response stream into the HTTP response stream
+    if (encoding != Encoding::Identity) {
+        StreamError stream_err = compress_stream(read_stream, write_stream, encoding);
+        if (stream_err != StreamError::Success) {
+            error("Error when compressing: " + to_string(stream_err));
+            return false;
+        }
+        info("Successfully compressed the response");
+        return true;
+    }
+
     // Pipe the fetch response stream into the HTTP response stream
     StreamError stream_err = read_stream.pipe_to(write_stream);
     if (stream_err == StreamError::Success) {
@@ -0,0 +1,59 @@
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+#include "bench.hpp"
+
+static uint64_t allocation_count = 0;
+static uint64_t allocation_bytes = 0;
+
+void * operator new(size_t size) {
+    allocation_count++;
+    allocation_bytes += size;
+    void * ptr = malloc(size == 0 ? 1 : size);
+    if (ptr == nullptr) {
+        abort();
+    }
+    return ptr;
+}
+
+void operator delete(void * ptr) noexcept {
+    free(ptr);
+}
+
+void operator delete(void * ptr, size_t) noexcept {
+    free(ptr);
+}
+
+namespace bench {
+
+uint64_t allocations() {
+    return allocation_count;
+}
+
+uint64_t allocated_bytes() {
+    return allocation_bytes;
+}
+
+size_t iterations(int argc, char ** argv, size_t default_iterations) {
+    for (int i = 1; i + 1 < argc; i++) {
+        if (strcmp(argv[i], "--iterations") == 0) {
+            return strtoull(argv[i + 1], nullptr, 10);
+        }
+    }
+    return default_iterations;
+}
+
+void print(const Result & result) {
+    printf("%-32s %10zu iterations %12.1f ns/op %8.2f allocs/op %10.1f B/op\n",
+        result.name.c_str(), result.iterations, result.ns_per_op, result.allocations_per_op, result.bytes_per_op);
+}
+
+void compare(const Result & baseline, const Result & result) {
+    printf("%s vs %s: %.2fx faster, %.2f fewer allocs/op\n",
+        result.name.c_str(), baseline.name.c_str(), baseline.ns_per_op / result.ns_per_op,
+        baseline.allocations_per_op - result.allocations_per_op);
+}
+
+} // namespace bench
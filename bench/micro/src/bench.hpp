@@ -0,0 +1,61 @@
+#ifndef BENCH_HPP
+#define BENCH_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <chrono>
+#include <string>
+
+namespace bench {
+
+struct Result {
+    std::string name;
+    size_t iterations;
+    double ns_per_op;
+    double allocations_per_op;
+    double bytes_per_op;
+};
+
+// Number of heap allocations and allocated bytes since the start of the process
+// (counted by the replaced global operator new in bench.cpp)
+uint64_t allocations();
+uint64_t allocated_bytes();
+
+// Iteration count from `--iterations N`, or `default_iterations`
+size_t iterations(int argc, char ** argv, size_t default_iterations);
+
+void print(const Result & result);
+// Prints `result` relative to `baseline`
+void compare(const Result & baseline, const Result & result);
+
+// Runs `op(i)` for i in [0, iterations) after a short warm-up and prints
+// the time and heap allocations per operation. `op` returns a value that
+// depends on its work, so that the compiler cannot drop it.
+template <typename Op>
+Result run(const std::string & name, size_t iterations, Op && op) {
+    volatile size_t sink = 0;
+    for (size_t i = 0; i < iterations / 10 + 1; i++) {
+        sink = sink + op(i);
+    }
+
+    uint64_t allocations_before = allocations();
+    uint64_t bytes_before = allocated_bytes();
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < iterations; i++) {
+        sink = sink + op(i);
+    }
+    std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+
+    Result result;
+    result.name = name;
+    result.iterations = iterations;
+    result.ns_per_op = std::chrono::duration<double, std::nano>(end - start).count() / iterations;
+    result.allocations_per_op = static_cast<double>(allocations() - allocations_before) / iterations;
+    result.bytes_per_op = static_cast<double>(allocated_bytes() - bytes_before) / iterations;
+    print(result);
+    return result;
+}
+
+} // namespace bench
+
+#endif // BENCH_HPP
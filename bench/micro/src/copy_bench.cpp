@@ -0,0 +1,109 @@
+// Microbenchmark of request-to-response echo: the read_chunk()/write_chunk()
+// loop of http-streaming-request-response vs edjsamples::stream::copy() vs
+// ReadStream::pipe_to() of http-streaming-request-response-pipe.
+//
+// Every iteration copies 4 MiB in 64 KiB chunks from an in-memory source
+// into a sink that only counts the bytes. In the EDJX runtime, pipe_to()
+// moves the chunks on the host side, without copying them into the
+// function's memory; edjx-sim implements it with a loop, so here it shows
+// only the cost of that loop.
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+#include <edjx/stream.hpp>
+#include <edjsamples/stream.hpp>
+
+#include "bench.hpp"
+
+using edjx::error::StreamError;
+using edjx::stream::ReadStream;
+using edjx::stream::WriteStream;
+using edjsamples::stream::CopyStats;
+using edjsamples::stream::ChunkPool;
+
+static const size_t CHUNK_SIZE = 64 * 1024;
+static const size_t TRANSFER_SIZE = 4 * 1024 * 1024;
+
+class MemorySource : public edjx::stream::detail::ReadSource {
+public:
+    StreamError read_chunk(std::vector<uint8_t> & chunk) override {
+        if (offset == TRANSFER_SIZE) {
+            return StreamError::EndOfStream;
+        }
+        chunk.resize(CHUNK_SIZE);
+        memset(chunk.data(), 'x', chunk.size());
+        offset += CHUNK_SIZE;
+        return StreamError::Success;
+    }
+
+    StreamError close() override {
+        return StreamError::Success;
+    }
+
+private:
+    size_t offset = 0;
+};
+
+class CountingSink : public edjx::stream::detail::WriteSink {
+public:
+    StreamError write_chunk(const uint8_t *, size_t size) override {
+        bytes += size;
+        return StreamError::Success;
+    }
+
+    StreamError close() override {
+        return StreamError::Success;
+    }
+
+    StreamError abort() override {
+        return StreamError::Success;
+    }
+
+    size_t bytes = 0;
+};
+
+int main(int argc, char ** argv) {
+    size_t iterations = bench::iterations(argc, argv, 200);
+
+    std::shared_ptr<CountingSink> sink = std::make_shared<CountingSink>();
+
+    bench::Result loop = bench::run("read_chunk/write_chunk loop", iterations, [&](size_t) {
+        ReadStream read_stream(std::make_shared<MemorySource>());
+        WriteStream write_stream(sink);
+        std::vector<uint8_t> chunk;
+        size_t count = 0;
+        while (read_stream.read_chunk(chunk) == StreamError::Success) {
+            write_stream.write_chunk(chunk);
+            count++;
+        }
+        return count;
+    });
+
+    ChunkPool pool(1, CHUNK_SIZE);
+    CopyStats stats;
+    bench::Result copied = bench::run("stream::copy", iterations, [&](size_t) {
+        ReadStream read_stream(std::make_shared<MemorySource>());
+        WriteStream write_stream(sink);
+        edjsamples::stream::copy(read_stream, write_stream, stats, pool);
+        return static_cast<size_t>(stats.chunks);
+    });
+
+    bench::Result piped = bench::run("ReadStream::pipe_to", iterations, [&](size_t) {
+        ReadStream read_stream(std::make_shared<MemorySource>());
+        WriteStream write_stream(sink);
+        read_stream.pipe_to(write_stream);
+        return sink->bytes;
+    });
+
+    bench::compare(loop, copied);
+    bench::compare(loop, piped);
+
+    printf("stream::copy: %.1f us/op waiting for reads, %.1f us/op for writes\n",
+        stats.read_stall.count() / 1000.0 / (iterations + iterations / 10 + 1),
+        stats.write_stall.count() / 1000.0 / (iterations + iterations / 10 + 1));
+    return EXIT_SUCCESS;
+}
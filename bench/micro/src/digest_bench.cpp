@@ -0,0 +1,141 @@
+// Microbenchmark of the upload digests of edjstorage-put-with-http-streaming-userdata:
+//
+// - upload: 16 MiB written in 64 KiB chunks into an edjx-sim storage upload
+//   (a file in a temporary directory), through WriteStream::write_chunk() vs
+//   edjsamples::digest::DigestWriteStream, which computes CRC32C and SHA-256
+// - crc32c, sha256: the checksums alone over the same chunks
+//
+// The hardware paths of digest.hpp are used only if the benchmark is built
+// with them enabled, e.g., `make run CFLAGS="-std=c++17 -O2 -march=native"`.
+
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include <unistd.h>
+#include <sys/stat.h>
+
+#include <edjx/storage.hpp>
+#include <edjx/stream.hpp>
+#include <edjsamples/digest.hpp>
+
+#include "bench.hpp"
+
+using edjx::error::StorageError;
+using edjx::error::StreamError;
+using edjx::storage::StorageResponse;
+using edjx::storage::StorageResponsePending;
+using edjx::stream::WriteStream;
+using edjsamples::digest::Crc32c;
+using edjsamples::digest::DigestWriteStream;
+using edjsamples::digest::Sha256;
+
+static const size_t CHUNK_SIZE = 64 * 1024;
+static const size_t UPLOAD_SIZE = 16 * 1024 * 1024;
+
+static std::string create_storage() {
+    char dir[] = "/tmp/digest_bench.XXXXXX";
+    if (mkdtemp(dir) == nullptr) {
+        perror("mkdtemp");
+        exit(EXIT_FAILURE);
+    }
+    setenv("EDJX_SIM_STORAGE_DIR", dir, 1);
+    return dir;
+}
+
+static void remove_storage(const std::string & storage_dir) {
+    unlink((storage_dir + "/objects/bench/object").c_str());
+    unlink((storage_dir + "/attributes/bench/object").c_str());
+    rmdir((storage_dir + "/objects/bench").c_str());
+    rmdir((storage_dir + "/attributes/bench").c_str());
+    rmdir((storage_dir + "/objects").c_str());
+    rmdir((storage_dir + "/attributes").c_str());
+    rmdir(storage_dir.c_str());
+}
+
+static WriteStream open_upload(StorageResponsePending & pending) {
+    WriteStream write_stream;
+    if (edjx::storage::put_streaming(pending, write_stream, "bench", "object", "") != StorageError::Success) {
+        fprintf(stderr, "Could not open the benchmark upload\n");
+        exit(EXIT_FAILURE);
+    }
+    return write_stream;
+}
+
+static void finish_upload(StorageResponsePending & pending) {
+    StorageResponse response;
+    pending.get_storage_response(response);
+}
+
+static void print_throughput(const bench::Result & result) {
+    printf("%-32s %10.1f MB/s\n", result.name.c_str(), UPLOAD_SIZE / result.ns_per_op * 1000);
+}
+
+int main(int argc, char ** argv) {
+    size_t iterations = bench::iterations(argc, argv, 20);
+    std::string storage_dir = create_storage();
+
+    std::vector<uint8_t> chunk(CHUNK_SIZE);
+    for (size_t i = 0; i < chunk.size(); i++) {
+        chunk[i] = static_cast<uint8_t>(i * 131 + (i >> 8));
+    }
+
+    bench::Result plain = bench::run("upload: write_chunk", iterations, [&](size_t) {
+        StorageResponsePending pending;
+        WriteStream write_stream = open_upload(pending);
+        for (size_t i = 0; i < UPLOAD_SIZE / CHUNK_SIZE; i++) {
+            write_stream.write_chunk(chunk);
+        }
+        write_stream.close();
+        finish_upload(pending);
+        return UPLOAD_SIZE;
+    });
+
+    bench::Result hashed = bench::run("upload: DigestWriteStream", iterations, [&](size_t) {
+        StorageResponsePending pending;
+        WriteStream write_stream = open_upload(pending);
+        DigestWriteStream digest_stream(write_stream);
+        for (size_t i = 0; i < UPLOAD_SIZE / CHUNK_SIZE; i++) {
+            digest_stream.write_chunk(chunk);
+        }
+        digest_stream.close();
+        finish_upload(pending);
+        return digest_stream.sha256_hex().size();
+    });
+
+    bench::compare(plain, hashed);
+
+    bench::Result crc_scalar = bench::run("crc32c: slicing-by-8", iterations, [&](size_t) {
+        uint32_t crc = 0xFFFFFFFF;
+        for (size_t i = 0; i < UPLOAD_SIZE / CHUNK_SIZE; i++) {
+            crc = edjsamples::digest::detail::crc32c_update_scalar(crc, chunk.data(), chunk.size());
+        }
+        return static_cast<size_t>(crc);
+    });
+
+    bench::Result crc = bench::run("crc32c: Crc32c", iterations, [&](size_t) {
+        Crc32c crc32c;
+        for (size_t i = 0; i < UPLOAD_SIZE / CHUNK_SIZE; i++) {
+            crc32c.update(chunk);
+        }
+        return static_cast<size_t>(crc32c.value());
+    });
+
+    bench::Result sha = bench::run("sha256: Sha256", iterations, [&](size_t) {
+        Sha256 sha256;
+        for (size_t i = 0; i < UPLOAD_SIZE / CHUNK_SIZE; i++) {
+            sha256.update(chunk);
+        }
+        return static_cast<size_t>(sha256.finish()[0]);
+    });
+
+    print_throughput(plain);
+    print_throughput(hashed);
+    print_throughput(crc_scalar);
+    print_throughput(crc);
+    print_throughput(sha);
+
+    remove_storage(storage_dir);
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,192 @@
+// Microbenchmark of FileAttributes serialization: the to_json() function of
+// edjstorage-get-attributes built on sanitize_json_string() vs
+// edjsamples::json::Writer, and the scalar vs vectorized escape scan.
+//
+// The property map is what a bucket typically stores: a few HTTP headers
+// and user metadata with longer free-form values, some of which contain
+// quotes, backslashes, and line breaks.
+
+#include <cstdlib>
+#include <string>
+#include <string_view>
+#include <map>
+
+#include <edjx/storage.hpp>
+#include <edjsamples/json.hpp>
+
+#include "bench.hpp"
+
+using edjx::storage::FileAttributes;
+using edjsamples::json::CountingSink;
+using edjsamples::json::StringSink;
+using edjsamples::json::Writer;
+
+static std::string legacy_sanitize_json_string(const std::string & value) {
+    std::string escaped;
+    escaped.reserve(value.length()); // May grow larger
+
+    for (char c : value) {
+        switch (c) {
+            case '\"':
+                escaped += "\\\"";
+                break;
+            case '\\':
+                escaped += "\\\\";
+                break;
+            case '\b':
+                escaped += "\\b";
+                break;
+            case '\f':
+                escaped += "\\f";
+                break;
+            case '\n':
+                escaped += "\\n";
+                break;
+            case '\r':
+                escaped += "\\r";
+                break;
+            case '\t':
+                escaped += "\\t";
+                break;
+            default:
+                escaped += c;
+                break;
+        }
+    }
+    return escaped;
+}
+
+static std::string legacy_to_json(const FileAttributes & file_attributes) {
+    std::string json = "{\"properties\":";
+    if (file_attributes.properties_present) {
+        json += "{";
+        bool first_entry = true;
+        for (const auto & property : file_attributes.properties) {
+            if (first_entry) {
+                first_entry = false;
+            } else {
+                json += ",";
+            }
+            json += "\"" + legacy_sanitize_json_string(property.first) + "\":\"" + legacy_sanitize_json_string(property.second) + "\"";
+        }
+        json += "}";
+    } else {
+        json += "null";
+    }
+
+    json += ",\"defaultVersion\":";
+    if (file_attributes.default_version_present) {
+        json += "\"" + legacy_sanitize_json_string(file_attributes.default_version) + "\"";
+    } else {
+        json += "null";
+    }
+    json += "}";
+
+    return json;
+}
+
+template <typename Sink>
+static void write_json(Sink & sink, const FileAttributes & file_attributes) {
+    Writer<Sink> writer(sink);
+    writer.begin_object();
+    writer.key("properties");
+    if (file_attributes.properties_present) {
+        writer.begin_object();
+        for (const auto & property : file_attributes.properties) {
+            writer.key(property.first);
+            writer.string(property.second);
+        }
+        writer.end_object();
+    } else {
+        writer.null();
+    }
+    writer.key("defaultVersion");
+    if (file_attributes.default_version_present) {
+        writer.string(file_attributes.default_version);
+    } else {
+        writer.null();
+    }
+    writer.end_object();
+}
+
+static std::string writer_to_json(const FileAttributes & file_attributes) {
+    CountingSink counter;
+    write_json(counter, file_attributes);
+
+    std::string json;
+    json.reserve(counter.size());
+    StringSink sink(json);
+    write_json(sink, file_attributes);
+    return json;
+}
+
+// edjsamples::json::write_escaped() with the byte-at-a-time scan
+template <typename Sink>
+static void write_escaped_scalar(Sink & sink, std::string_view value) {
+    const char * data = value.data();
+    size_t size = value.size();
+    while (size > 0) {
+        size_t clean = edjsamples::json::detail::find_escape_scalar(data, size);
+        if (clean > 0) {
+            sink.write(data, clean);
+        }
+        if (clean == size) {
+            break;
+        }
+        edjsamples::json::detail::write_escape(sink, data[clean]);
+        data += clean + 1;
+        size -= clean + 1;
+    }
+}
+
+int main(int argc, char ** argv) {
+    size_t iterations = bench::iterations(argc, argv, 100000);
+
+    FileAttributes attributes;
+    attributes.properties_present = true;
+    attributes.properties = {
+        {"Cache-Control", "public, max-age=31536000, immutable"},
+        {"Content-Disposition", "attachment; filename=\"IMG_20221104_153012.jpg\""},
+        {"Content-Type", "image/jpeg"},
+        {"x-meta-author", "Jane Doe <jane.doe@example.com>"},
+        {"x-meta-camera", "Canon EOS R6; RF24-105mm F4 L IS USM; f/8, 1/250 s, ISO 100"},
+        {"x-meta-description", "Sunset over the harbour, taken from the north pier. "
+            "The lighthouse is visible on the left; the ferry to the island is leaving the port.\n"
+            "Colour-graded in post, original RAW kept in the archive bucket."},
+        {"x-meta-path", "C:\\Users\\jane\\Pictures\\2022\\11\\IMG_20221104_153012.CR3"},
+        {"x-meta-tags", "sunset,harbour,lighthouse,ferry,long-exposure,landscape,travel"},
+        {"x-meta-uploaded-by", "uploader-service/2.4.1 (build 8f3c2e1)"},
+    };
+    attributes.default_version_present = true;
+    attributes.default_version = "3f2a9c1e-7b4d-4e8a-9c6f-0d1e2b3a4c5d";
+
+    bench::Result legacy = bench::run("sanitize_json_string", iterations, [&](size_t) {
+        return legacy_to_json(attributes).size();
+    });
+
+    bench::Result writer = bench::run("json::Writer", iterations, [&](size_t) {
+        return writer_to_json(attributes).size();
+    });
+
+    bench::compare(legacy, writer);
+
+    // Escape scan alone, over the property values
+    bench::Result scalar = bench::run("scan: scalar", iterations, [&](size_t) {
+        CountingSink counter;
+        for (const auto & property : attributes.properties) {
+            write_escaped_scalar(counter, property.second);
+        }
+        return counter.size();
+    });
+
+    bench::Result vectorized = bench::run("scan: 16 bytes at a time", iterations, [&](size_t) {
+        CountingSink counter;
+        for (const auto & property : attributes.properties) {
+            edjsamples::json::write_escaped(counter, property.second);
+        }
+        return counter.size();
+    });
+
+    bench::compare(scalar, vectorized);
+    return EXIT_SUCCESS;
+}
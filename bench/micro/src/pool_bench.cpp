@@ -0,0 +1,169 @@
+// Microbenchmark of the chunk buffers of streaming loops: a new buffer for
+// every chunk vs the reused buffers of edjsamples::stream::ChunkPool.
+//
+// - read: a 1 GiB object of edjx-sim storage is read chunk by chunk (64 KiB,
+//   the edjx-sim default) and written to a sink that only counts the bytes,
+//   as in edjstorage-get-with-http-streaming. The allocations per operation
+//   are the allocations of the whole 1 GiB transfer; with ChunkPool, only
+//   opening the object allocates (paths, headers, the stream).
+// - write: the text of edjstorage-put-with-http-streaming is written in
+//   chunks of increasing sizes, from std::string copies vs with ChunkWriter.
+
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#include <edjx/storage.hpp>
+#include <edjx/stream.hpp>
+#include <edjsamples/stream.hpp>
+
+#include "bench.hpp"
+
+using edjx::error::StorageError;
+using edjx::error::StreamError;
+using edjx::storage::StorageResponse;
+using edjx::stream::ReadStream;
+using edjx::stream::WriteStream;
+using edjsamples::stream::ByteSpan;
+using edjsamples::stream::ChunkPool;
+using edjsamples::stream::ChunkReader;
+using edjsamples::stream::ChunkWriter;
+
+static const off_t OBJECT_SIZE = 1024LL * 1024 * 1024;
+static const size_t CHUNK_CAPACITY = 64 * 1024;
+
+static const std::string CONTENT = "WHERE IS THE EDGE, ANYWAY?\nIf you ask a cloud company, they tell you the edge is their multi-billion dollar collection of server farms. A content delivery network (CDN) provider says it's their hundreds of points of presence. Wireless carriers will try to convince you it's their tens of thousands of macrocell and picocell sites.\n\nAt EDJX, we say the edge is anywhere and everywhere, a thousand feet away from you at all times. We believe computing needs to become ubiquitous, like electricity, to power billions of connected devices.\nThe edge will go so far out into the woods, you can hear the sasquatch scream.";
+
+class CountingSink : public edjx::stream::detail::WriteSink {
+public:
+    StreamError write_chunk(const uint8_t *, size_t size) override {
+        bytes += size;
+        return StreamError::Success;
+    }
+
+    StreamError close() override {
+        return StreamError::Success;
+    }
+
+    StreamError abort() override {
+        return StreamError::Success;
+    }
+
+    size_t bytes = 0;
+};
+
+// Creates a sparse 1 GiB object "bench/object" in a temporary edjx-sim
+// storage directory, returns the directory
+static std::string create_object() {
+    char dir[] = "/tmp/pool_bench.XXXXXX";
+    if (mkdtemp(dir) == nullptr) {
+        perror("mkdtemp");
+        exit(EXIT_FAILURE);
+    }
+    std::string storage_dir = dir;
+    mkdir((storage_dir + "/objects").c_str(), 0755);
+    mkdir((storage_dir + "/objects/bench").c_str(), 0755);
+    int fd = open((storage_dir + "/objects/bench/object").c_str(), O_CREAT | O_WRONLY, 0644);
+    if (fd < 0 || ftruncate(fd, OBJECT_SIZE) != 0) {
+        perror("object");
+        exit(EXIT_FAILURE);
+    }
+    close(fd);
+    setenv("EDJX_SIM_STORAGE_DIR", storage_dir.c_str(), 1);
+    return storage_dir;
+}
+
+static void remove_object(const std::string & storage_dir) {
+    unlink((storage_dir + "/objects/bench/object").c_str());
+    rmdir((storage_dir + "/objects/bench").c_str());
+    rmdir((storage_dir + "/objects").c_str());
+    rmdir(storage_dir.c_str());
+}
+
+static ReadStream open_object() {
+    StorageResponse response;
+    if (edjx::storage::get(response, "bench", "object") != StorageError::Success) {
+        fprintf(stderr, "Could not open the benchmark object\n");
+        exit(EXIT_FAILURE);
+    }
+    return response.get_read_stream();
+}
+
+int main(int argc, char ** argv) {
+    size_t iterations = bench::iterations(argc, argv, 2);
+    std::string storage_dir = create_object();
+
+    std::shared_ptr<CountingSink> sink = std::make_shared<CountingSink>();
+
+    bench::Result read_new = bench::run("read: new buffer per chunk", iterations, [&](size_t) {
+        ReadStream read_stream = open_object();
+        WriteStream write_stream(sink);
+        size_t count = 0;
+        while (true) {
+            std::vector<uint8_t> chunk;
+            if (read_stream.read_chunk(chunk) != StreamError::Success) {
+                break;
+            }
+            write_stream.write_chunk(chunk);
+            count++;
+        }
+        read_stream.close();
+        return count;
+    });
+
+    ChunkPool pool(2, CHUNK_CAPACITY);
+    uint64_t reallocations = 0;
+    bench::Result read_pooled = bench::run("read: ChunkPool", iterations, [&](size_t) {
+        ReadStream read_stream = open_object();
+        WriteStream write_stream(sink);
+        ChunkReader reader(read_stream, pool);
+        ByteSpan chunk;
+        size_t count = 0;
+        while (reader.read(chunk) == StreamError::Success) {
+            write_stream.write_chunk(reader.last_chunk());
+            count++;
+        }
+        reallocations += reader.reallocations();
+        read_stream.close();
+        return count;
+    });
+
+    bench::compare(read_new, read_pooled);
+    printf("read: ChunkPool: %zu chunks/op, %llu buffer reallocations, %zu pool allocations\n",
+        static_cast<size_t>(OBJECT_SIZE / CHUNK_CAPACITY), static_cast<unsigned long long>(reallocations),
+        pool.allocations());
+
+    bench::Result write_strings = bench::run("write: std::string chunks", iterations * 10000, [&](size_t) {
+        WriteStream write_stream(sink);
+        size_t count = 0;
+        for (size_t i = 0, len = 1; i < CONTENT.length(); i += len, len++) {
+            std::string chunk = CONTENT.substr(i, len);
+            write_stream.write_chunk(chunk);
+            count++;
+        }
+        return count;
+    });
+
+    bench::Result write_pooled = bench::run("write: ChunkWriter", iterations * 10000, [&](size_t) {
+        WriteStream write_stream(sink);
+        ChunkWriter writer(write_stream, pool);
+        size_t count = 0;
+        for (size_t i = 0, len = 1; i < CONTENT.length(); i += len, len++) {
+            writer.write(std::string_view(CONTENT).substr(i, len));
+            count++;
+        }
+        return count;
+    });
+
+    bench::compare(write_strings, write_pooled);
+
+    remove_object(storage_dir);
+    return EXIT_SUCCESS;
+}
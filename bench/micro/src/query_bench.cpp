@@ -0,0 +1,94 @@
+// Microbenchmark of query parameter lookup: the query_param_by_name()
+// function that was copied into the samples vs edjsamples::query::QueryParams.
+//
+// Every iteration looks up the parameters of a storage request
+// (file_name, bucket_id, properties), as edjstorage-put-with-http does.
+
+#include <cstdlib>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <optional>
+
+#include <edjsamples/query.hpp>
+
+#include "bench.hpp"
+
+using edjsamples::query::QueryParams;
+
+static std::optional<std::string> legacy_query_param_by_name(const std::string & req_uri, const std::string & param_name) {
+    std::string uri = req_uri;
+    std::vector<std::pair<std::string, std::string>> query_parsed;
+
+    size_t query_start = uri.find('?');
+
+    if (query_start != std::string::npos) {
+        std::string name;
+        std::string value;
+        bool parsing_name = true;
+        for (std::string::iterator it = uri.begin() + query_start + 1; it != uri.end(); ++it) {
+            char c = *it;
+            switch (c) {
+                case '?':
+                    break;
+                case '=':
+                    parsing_name = false;
+                    break;
+                case '&':
+                    query_parsed.push_back(make_pair(name, value));
+                    name.clear();
+                    value.clear();
+                    parsing_name = true;
+                    break;
+                default:
+                    if (parsing_name) {
+                        name += c;
+                    } else {
+                        value += c;
+                    }
+                    break;
+            }
+        }
+        if (!name.empty() || !value.empty()) {
+            query_parsed.push_back(make_pair(name, value));
+        }
+
+        for (const auto & parameter : query_parsed) {
+            if (parameter.first == param_name) {
+                return parameter.second;
+            }
+        }
+    }
+
+    return {};
+}
+
+static const char * const URIS[] = {
+    "https://example.com/storage-put?file_name=hello.txt&bucket_id=0d5c5fe3-3b0d-4b5b-a5bf-6f2c06d4d0b3",
+    "https://example.com/storage-put?file_name=images%2Flogo.png&bucket_id=0d5c5fe3-3b0d-4b5b-a5bf-6f2c06d4d0b3&properties=content-type=image/png,cache-control=max-age%3D3600",
+    "https://example.com/storage-put?utm_source=newsletter&utm_medium=email&utm_campaign=launch&file_name=report-2022-12.pdf&bucket_id=0d5c5fe3-3b0d-4b5b-a5bf-6f2c06d4d0b3&properties=a=b",
+};
+
+int main(int argc, char ** argv) {
+    size_t iterations = bench::iterations(argc, argv, 200000);
+    std::vector<std::string> uris(std::begin(URIS), std::end(URIS));
+
+    bench::Result legacy = bench::run("query_param_by_name", iterations, [&](size_t i) {
+        const std::string & uri = uris[i % uris.size()];
+        std::optional<std::string> file_name = legacy_query_param_by_name(uri, "file_name");
+        std::optional<std::string> bucket_id = legacy_query_param_by_name(uri, "bucket_id");
+        std::optional<std::string> properties = legacy_query_param_by_name(uri, "properties");
+        return file_name->size() + bucket_id->size() + properties.value_or("").size();
+    });
+
+    bench::Result shared = bench::run("QueryParams", iterations, [&](size_t i) {
+        QueryParams query(uris[i % uris.size()]);
+        std::optional<std::string_view> file_name = query.get("file_name");
+        std::optional<std::string_view> bucket_id = query.get("bucket_id");
+        std::optional<std::string_view> properties = query.get("properties");
+        return file_name->size() + bucket_id->size() + properties.value_or("").size();
+    });
+
+    bench::compare(legacy, shared);
+    return EXIT_SUCCESS;
+}
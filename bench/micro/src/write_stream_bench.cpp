@@ -0,0 +1,112 @@
+// Microbenchmark of small stream writes: WriteStream::write_chunk() for every
+// piece of data vs edjsamples::stream::BufferedWriteStream, with the write
+// patterns of two samples:
+//
+// - basic-http-fetch-request-streaming: about 600 bytes of text written in
+//   chunks of increasing sizes (1, 2, 3, ... bytes)
+// - http-response-streaming: 10,000 lines of "Chunk i/10000\r\n"
+//
+// The stream is backed by a sink that only counts the calls, so the times are
+// the cost on the function's side; every write_chunk() is a host call in the
+// EDJX runtime, which this benchmark reports as host calls per operation.
+
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <string_view>
+
+#include <edjx/stream.hpp>
+#include <edjsamples/stream.hpp>
+
+#include "bench.hpp"
+
+using edjx::error::StreamError;
+using edjx::stream::WriteStream;
+using edjsamples::stream::BufferedWriteStream;
+
+class CountingSink : public edjx::stream::detail::WriteSink {
+public:
+    StreamError write_chunk(const uint8_t *, size_t size) override {
+        calls++;
+        bytes += size;
+        return StreamError::Success;
+    }
+
+    StreamError close() override {
+        return StreamError::Success;
+    }
+
+    StreamError abort() override {
+        return StreamError::Success;
+    }
+
+    size_t calls = 0;
+    size_t bytes = 0;
+};
+
+static const std::string CONTENT = "WHERE IS THE EDGE, ANYWAY?\nIf you ask a cloud company, they tell you the edge is their multi-billion dollar collection of server farms. A content delivery network (CDN) provider says it's their hundreds of points of presence. Wireless carriers will try to convince you it's their tens of thousands of macrocell and picocell sites.\n\nAt EDJX, we say the edge is anywhere and everywhere, a thousand feet away from you at all times. We believe computing needs to become ubiquitous, like electricity, to power billions of connected devices.\nThe edge will go so far out into the woods, you can hear the sasquatch scream.";
+
+static const uint32_t LINES = 10000;
+
+template <typename Stream>
+static void write_increasing_chunks(Stream & stream) {
+    for (size_t i = 0, len = 1; i < CONTENT.length(); i += len, len++) {
+        stream.write_chunk(CONTENT.substr(i, len));
+    }
+    stream.close();
+}
+
+template <typename Stream>
+static void write_lines(Stream & stream) {
+    for (uint32_t i = 0; i < LINES; i++) {
+        stream.write_chunk("Chunk " + std::to_string(i) + "/" + std::to_string(LINES) + "\r\n");
+    }
+    stream.close();
+}
+
+static void print_host_calls(const std::string & name, const CountingSink & sink, size_t iterations) {
+    printf("%-32s %10.1f host calls/op %10.1f bytes/call\n",
+        name.c_str(), static_cast<double>(sink.calls) / iterations,
+        sink.calls == 0 ? 0.0 : static_cast<double>(sink.bytes) / sink.calls);
+}
+
+template <typename Write>
+static bench::Result run(const std::string & name, size_t iterations, bool buffered, Write && write) {
+    std::shared_ptr<CountingSink> sink = std::make_shared<CountingSink>();
+    bench::Result result = bench::run(name, iterations, [&](size_t) {
+        WriteStream write_stream(sink);
+        if (buffered) {
+            BufferedWriteStream buffered_stream(write_stream);
+            write(buffered_stream);
+        } else {
+            write(write_stream);
+        }
+        return sink->calls;
+    });
+    // The warm-up iterations are counted too
+    print_host_calls(name, *sink, iterations + iterations / 10 + 1);
+    return result;
+}
+
+int main(int argc, char ** argv) {
+    size_t iterations = bench::iterations(argc, argv, 2000);
+
+    bench::Result increasing = run("fetch: write_chunk", iterations * 10, false, [](auto & stream) {
+        write_increasing_chunks(stream);
+    });
+    bench::Result increasing_buffered = run("fetch: BufferedWriteStream", iterations * 10, true, [](auto & stream) {
+        write_increasing_chunks(stream);
+    });
+    bench::compare(increasing, increasing_buffered);
+
+    bench::Result lines = run("response: write_chunk", iterations, false, [](auto & stream) {
+        write_lines(stream);
+    });
+    bench::Result lines_buffered = run("response: BufferedWriteStream", iterations, true, [](auto & stream) {
+        write_lines(stream);
+    });
+    bench::compare(lines, lines_buffered);
+
+    return EXIT_SUCCESS;
+}
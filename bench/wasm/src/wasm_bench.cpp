@@ -0,0 +1,486 @@
+// Per-invocation latency benchmark for the sample WASM modules.
+//
+// Every request of the corpus is replayed in a fresh instance of the module
+// (as the EDJX executor does): the module is instantiated, the exported
+// init() function is called and the response written to stdout is captured.
+//
+// Modules built with `make wasm-sim` import only WASI, so the request is
+// served by edjx-sim inside the module. Modules built against the EDJX SDK
+// (`make all`) are accepted as well; their EDJX host imports are replaced
+// by stubs that return zeros, which is enough to measure instantiation and
+// startup cost but not a full request.
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cstdint>
+#include <chrono>
+#include <thread>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <fcntl.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <sys/stat.h>
+
+#include <wasmtime.h>
+
+typedef std::chrono::steady_clock Clock;
+
+static const char * const WASI_MODULE = "wasi_snapshot_preview1";
+
+struct Options {
+    std::string module_path;
+    std::string corpus_dir;
+    std::string sdk_version = "unknown";
+    size_t iterations = 1000;
+    size_t warmup = 10;
+    bool inherit_stderr = false;
+    std::vector<std::pair<std::string, std::string>> env;
+    std::vector<std::pair<std::string, std::string>> dirs; // guest path, host path
+};
+
+struct Sample {
+    double instantiate_us;
+    double ttfb_us; // Negative if no response byte was written
+    double latency_us;
+};
+
+// Reads the response of one invocation from the stdout FIFO
+struct ResponseReader {
+    std::string fifo_path;
+    Clock::time_point first_byte;
+    bool got_first_byte = false;
+    std::string status_line;
+    std::thread thread;
+
+    void start() {
+        got_first_byte = false;
+        status_line.clear();
+        thread = std::thread([this]() {
+            int fd = open(fifo_path.c_str(), O_RDONLY);
+            if (fd < 0) {
+                return;
+            }
+            char buf[64 * 1024];
+            ssize_t n;
+            while ((n = read(fd, buf, sizeof(buf))) > 0) {
+                if (!got_first_byte) {
+                    first_byte = Clock::now();
+                    got_first_byte = true;
+                }
+                for (ssize_t i = 0; i < n && status_line.size() < 64 && status_line.find('\n') == std::string::npos; i++) {
+                    status_line += buf[i];
+                }
+            }
+            close(fd);
+        });
+    }
+
+    void join() {
+        if (thread.joinable()) {
+            thread.join();
+        }
+    }
+
+    // "HTTP/1.1 200 OK" -> 200
+    int status() const {
+        size_t space = status_line.find(' ');
+        return space == std::string::npos ? 0 : atoi(status_line.c_str() + space + 1);
+    }
+};
+
+static void usage(const char * argv0) {
+    fprintf(stderr,
+        "Usage: %s --module <file.wasm> --corpus <dir> [options]\n"
+        "\n"
+        "Options:\n"
+        "  --iterations <n>        Number of measured requests (default 1000)\n"
+        "  --warmup <n>            Number of requests before measuring (default 10)\n"
+        "  --sdk-version <version> EDJX C++ SDK version recorded in the results\n"
+        "  --env <NAME=VALUE>      Environment variable for the module (repeatable)\n"
+        "  --mapdir <GUEST::HOST>  Preopened directory for the module (repeatable)\n"
+        "  --stderr                Show log output of the module\n",
+        argv0);
+}
+
+static bool parse_options(int argc, char ** argv, Options & options) {
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--stderr") {
+            options.inherit_stderr = true;
+            continue;
+        }
+        if (i + 1 >= argc) {
+            return false;
+        }
+        std::string value = argv[++i];
+        if (arg == "--module") {
+            options.module_path = value;
+        } else if (arg == "--corpus") {
+            options.corpus_dir = value;
+        } else if (arg == "--iterations") {
+            options.iterations = strtoull(value.c_str(), nullptr, 10);
+        } else if (arg == "--warmup") {
+            options.warmup = strtoull(value.c_str(), nullptr, 10);
+        } else if (arg == "--sdk-version") {
+            options.sdk_version = value;
+        } else if (arg == "--env") {
+            size_t eq = value.find('=');
+            if (eq == std::string::npos) {
+                return false;
+            }
+            options.env.emplace_back(value.substr(0, eq), value.substr(eq + 1));
+        } else if (arg == "--mapdir") {
+            size_t sep = value.find("::");
+            if (sep == std::string::npos) {
+                return false;
+            }
+            options.dirs.emplace_back(value.substr(0, sep), value.substr(sep + 2));
+        } else {
+            return false;
+        }
+    }
+    return !options.module_path.empty() && !options.corpus_dir.empty() && options.iterations > 0;
+}
+
+// Every *.http file in the corpus directory is a raw HTTP/1.1 request
+static std::vector<std::string> load_corpus(const std::string & dir) {
+    std::vector<std::string> files;
+    DIR * d = opendir(dir.c_str());
+    if (d == nullptr) {
+        return files;
+    }
+    while (struct dirent * entry = readdir(d)) {
+        std::string name = entry->d_name;
+        if (name.size() > 5 && name.compare(name.size() - 5, 5, ".http") == 0) {
+            files.push_back(dir + "/" + name);
+        }
+    }
+    closedir(d);
+    std::sort(files.begin(), files.end());
+    return files;
+}
+
+static bool read_file(const std::string & path, std::vector<uint8_t> & data) {
+    FILE * file = fopen(path.c_str(), "rb");
+    if (file == nullptr) {
+        return false;
+    }
+    uint8_t buf[64 * 1024];
+    size_t n;
+    while ((n = fread(buf, 1, sizeof(buf), file)) > 0) {
+        data.insert(data.end(), buf, buf + n);
+    }
+    fclose(file);
+    return true;
+}
+
+static void print_error(const char * message, wasmtime_error_t * error, wasm_trap_t * trap) {
+    wasm_byte_vec_t error_message;
+    if (error != nullptr) {
+        wasmtime_error_message(error, &error_message);
+        wasmtime_error_delete(error);
+    } else if (trap != nullptr) {
+        wasm_trap_message(trap, &error_message);
+        wasm_trap_delete(trap);
+    } else {
+        fprintf(stderr, "%s\n", message);
+        return;
+    }
+    fprintf(stderr, "%s: %.*s\n", message, static_cast<int>(error_message.size), error_message.data);
+    wasm_byte_vec_delete(&error_message);
+}
+
+// Host import stub: counts the call and returns zeros
+static wasm_trap_t * stub_callback(
+    void * env,
+    wasmtime_caller_t * caller,
+    const wasmtime_val_t * args,
+    size_t nargs,
+    wasmtime_val_t * results,
+    size_t nresults
+) {
+    (*static_cast<uint64_t *>(env))++;
+    for (size_t i = 0; i < nresults; i++) {
+        memset(&results[i], 0, sizeof(results[i]));
+        results[i].kind = WASMTIME_I32;
+    }
+    return nullptr;
+}
+
+// Defines a zero-returning stub for every non-WASI function import
+static bool define_stubs(wasmtime_linker_t * linker, wasmtime_module_t * module, uint64_t * stub_calls) {
+    wasm_importtype_vec_t imports;
+    wasmtime_module_imports(module, &imports);
+    bool ok = true;
+    for (size_t i = 0; i < imports.size && ok; i++) {
+        const wasm_name_t * module_name = wasm_importtype_module(imports.data[i]);
+        const wasm_name_t * name = wasm_importtype_name(imports.data[i]);
+        if (module_name->size == strlen(WASI_MODULE) && memcmp(module_name->data, WASI_MODULE, module_name->size) == 0) {
+            continue;
+        }
+        const wasm_functype_t * functype = wasm_externtype_as_functype_const(wasm_importtype_type(imports.data[i]));
+        if (functype == nullptr) {
+            fprintf(stderr, "Unsupported non-function import %.*s::%.*s\n",
+                static_cast<int>(module_name->size), module_name->data,
+                static_cast<int>(name->size), name->data);
+            ok = false;
+            break;
+        }
+        wasmtime_error_t * error = wasmtime_linker_define_func(
+            linker, module_name->data, module_name->size, name->data, name->size,
+            functype, stub_callback, stub_calls, nullptr
+        );
+        if (error != nullptr) {
+            print_error("Could not define a host import stub", error, nullptr);
+            ok = false;
+        }
+    }
+    wasm_importtype_vec_delete(&imports);
+    return ok;
+}
+
+static double micros(Clock::time_point from, Clock::time_point to) {
+    return std::chrono::duration<double, std::micro>(to - from).count();
+}
+
+// Runs one request in a fresh store and instance
+static bool run_request(
+    wasm_engine_t * engine,
+    wasmtime_linker_t * linker,
+    wasmtime_module_t * module,
+    const Options & options,
+    const std::string & request_path,
+    ResponseReader & reader,
+    Sample & sample,
+    int & status
+) {
+    wasmtime_store_t * store = wasmtime_store_new(engine, nullptr, nullptr);
+    wasmtime_context_t * context = wasmtime_store_context(store);
+
+    wasi_config_t * wasi_config = wasi_config_new();
+    if (!wasi_config_set_stdin_file(wasi_config, request_path.c_str())) {
+        fprintf(stderr, "Could not open %s\n", request_path.c_str());
+        wasi_config_delete(wasi_config);
+        wasmtime_store_delete(store);
+        return false;
+    }
+    if (options.inherit_stderr) {
+        wasi_config_inherit_stderr(wasi_config);
+    }
+    std::vector<const char *> env_names;
+    std::vector<const char *> env_values;
+    for (const auto & var : options.env) {
+        env_names.push_back(var.first.c_str());
+        env_values.push_back(var.second.c_str());
+    }
+    wasi_config_set_env(wasi_config, static_cast<int>(env_names.size()), env_names.data(), env_values.data());
+    for (const auto & dir : options.dirs) {
+        if (!wasi_config_preopen_dir(wasi_config, dir.second.c_str(), dir.first.c_str())) {
+            fprintf(stderr, "Could not preopen %s\n", dir.second.c_str());
+        }
+    }
+
+    // Opening the FIFO for writing blocks until the reader opens it
+    reader.start();
+    if (!wasi_config_set_stdout_file(wasi_config, reader.fifo_path.c_str())) {
+        fprintf(stderr, "Could not open %s\n", reader.fifo_path.c_str());
+        // Unblock the reader
+        close(open(reader.fifo_path.c_str(), O_WRONLY));
+        reader.join();
+        wasi_config_delete(wasi_config);
+        wasmtime_store_delete(store);
+        return false;
+    }
+
+    wasmtime_error_t * error = wasmtime_context_set_wasi(context, wasi_config);
+    if (error != nullptr) {
+        print_error("Could not configure WASI", error, nullptr);
+        wasmtime_store_delete(store);
+        reader.join();
+        return false;
+    }
+
+    bool ok = true;
+    Clock::time_point start = Clock::now();
+    wasmtime_instance_t instance;
+    wasm_trap_t * trap = nullptr;
+    error = wasmtime_linker_instantiate(linker, context, module, &instance, &trap);
+    Clock::time_point instantiated = Clock::now();
+    Clock::time_point call_start = instantiated;
+    Clock::time_point call_end = instantiated;
+
+    if (error != nullptr || trap != nullptr) {
+        print_error("Could not instantiate the module", error, trap);
+        ok = false;
+    } else {
+        wasmtime_extern_t init;
+        if (!wasmtime_instance_export_get(context, &instance, "init", strlen("init"), &init)
+            || init.kind != WASMTIME_EXTERN_FUNC) {
+            fprintf(stderr, "The module does not export an init() function\n");
+            ok = false;
+        } else {
+            call_start = Clock::now();
+            error = wasmtime_func_call(context, &init.of.func, nullptr, 0, nullptr, 0, &trap);
+            call_end = Clock::now();
+
+            // The module exits through proc_exit(), which is not a failure
+            int exit_status = 0;
+            if (error != nullptr && wasmtime_error_exit_status(error, &exit_status)) {
+                wasmtime_error_delete(error);
+                error = nullptr;
+            }
+            if (error != nullptr || trap != nullptr) {
+                print_error("init() failed", error, trap);
+                ok = false;
+            }
+        }
+    }
+
+    // Deleting the store closes the stdout FIFO and ends the reader
+    wasmtime_store_delete(store);
+    reader.join();
+
+    sample.instantiate_us = micros(start, instantiated);
+    sample.latency_us = micros(call_start, call_end);
+    sample.ttfb_us = reader.got_first_byte ? micros(call_start, reader.first_byte) : -1.0;
+    status = reader.status();
+    return ok;
+}
+
+static void print_stats(const char * name, std::vector<double> values, bool last) {
+    printf("  \"%s\": ", name);
+    if (values.empty()) {
+        printf("null%s\n", last ? "" : ",");
+        return;
+    }
+    std::sort(values.begin(), values.end());
+    double sum = 0;
+    for (double v : values) {
+        sum += v;
+    }
+    // Nearest-rank percentiles
+    auto percentile = [&values](double p) {
+        size_t rank = static_cast<size_t>(p / 100.0 * values.size() + 0.5);
+        return values[std::min(values.size() - 1, rank == 0 ? 0 : rank - 1)];
+    };
+    printf("{\"mean\": %.3f, \"min\": %.3f, \"p50\": %.3f, \"p99\": %.3f, \"p999\": %.3f, \"max\": %.3f}%s\n",
+        sum / values.size(), values.front(), percentile(50), percentile(99), percentile(99.9), values.back(),
+        last ? "" : ",");
+}
+
+static std::string json_string(const std::string & str) {
+    std::string escaped = "\"";
+    for (char c : str) {
+        if (c == '"' || c == '\\') {
+            escaped += '\\';
+        }
+        escaped += c;
+    }
+    return escaped + "\"";
+}
+
+int main(int argc, char ** argv) {
+    Options options;
+    if (!parse_options(argc, argv, options)) {
+        usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    std::vector<std::string> corpus = load_corpus(options.corpus_dir);
+    if (corpus.empty()) {
+        fprintf(stderr, "No *.http requests found in %s\n", options.corpus_dir.c_str());
+        return EXIT_FAILURE;
+    }
+
+    std::vector<uint8_t> wasm;
+    if (!read_file(options.module_path, wasm)) {
+        fprintf(stderr, "Could not read %s\n", options.module_path.c_str());
+        return EXIT_FAILURE;
+    }
+
+    wasm_engine_t * engine = wasm_engine_new();
+
+    Clock::time_point compile_start = Clock::now();
+    wasmtime_module_t * module = nullptr;
+    wasmtime_error_t * error = wasmtime_module_new(engine, wasm.data(), wasm.size(), &module);
+    double compile_us = micros(compile_start, Clock::now());
+    if (error != nullptr) {
+        print_error("Could not compile the module", error, nullptr);
+        return EXIT_FAILURE;
+    }
+
+    uint64_t stub_calls = 0;
+    wasmtime_linker_t * linker = wasmtime_linker_new(engine);
+    error = wasmtime_linker_define_wasi(linker);
+    if (error != nullptr) {
+        print_error("Could not define WASI", error, nullptr);
+        return EXIT_FAILURE;
+    }
+    if (!define_stubs(linker, module, &stub_calls)) {
+        return EXIT_FAILURE;
+    }
+
+    char fifo_dir[] = "/tmp/wasm-bench-XXXXXX";
+    if (mkdtemp(fifo_dir) == nullptr) {
+        perror("mkdtemp");
+        return EXIT_FAILURE;
+    }
+    ResponseReader reader;
+    reader.fifo_path = std::string(fifo_dir) + "/stdout";
+    if (mkfifo(reader.fifo_path.c_str(), 0600) != 0) {
+        perror("mkfifo");
+        return EXIT_FAILURE;
+    }
+
+    std::vector<double> instantiate_us;
+    std::vector<double> ttfb_us;
+    std::vector<double> latency_us;
+    std::vector<double> cold_start_us;
+    size_t errors = 0;
+
+    for (size_t i = 0; i < options.warmup + options.iterations; i++) {
+        Sample sample;
+        int status = 0;
+        bool ok = run_request(engine, linker, module, options, corpus[i % corpus.size()], reader, sample, status);
+        if (i < options.warmup) {
+            continue;
+        }
+        if (!ok || status == 0 || status >= 500) {
+            errors++;
+        }
+        instantiate_us.push_back(sample.instantiate_us);
+        latency_us.push_back(sample.latency_us);
+        if (sample.ttfb_us >= 0) {
+            ttfb_us.push_back(sample.ttfb_us);
+        }
+        // Cold start: from the start of instantiation to the first response byte
+        cold_start_us.push_back(sample.instantiate_us + (sample.ttfb_us >= 0 ? sample.ttfb_us : sample.latency_us));
+    }
+
+    unlink(reader.fifo_path.c_str());
+    rmdir(fifo_dir);
+
+    printf("{\n");
+    printf("  \"module\": %s,\n", json_string(options.module_path).c_str());
+    printf("  \"sdk_version\": %s,\n", json_string(options.sdk_version).c_str());
+    printf("  \"module_size\": %zu,\n", wasm.size());
+    printf("  \"corpus_size\": %zu,\n", corpus.size());
+    printf("  \"requests\": %zu,\n", options.iterations);
+    printf("  \"errors\": %zu,\n", errors);
+    printf("  \"stubbed_host_calls\": %llu,\n", static_cast<unsigned long long>(stub_calls));
+    printf("  \"compile_us\": %.3f,\n", compile_us);
+    print_stats("instantiate_us", instantiate_us, false);
+    print_stats("ttfb_us", ttfb_us, false);
+    print_stats("latency_us", latency_us, false);
+    print_stats("cold_start_us", cold_start_us, true);
+    printf("}\n");
+
+    wasmtime_linker_delete(linker);
+    wasmtime_module_delete(module);
+    wasm_engine_delete(engine);
+
+    return errors == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
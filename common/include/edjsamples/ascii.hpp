@@ -0,0 +1,42 @@
+#ifndef EDJSAMPLES_ASCII_HPP
+#define EDJSAMPLES_ASCII_HPP
+
+#include <cstddef>
+#include <string_view>
+
+namespace edjsamples {
+namespace ascii {
+
+// Locale-independent helpers for protocol elements (header names, tokens, ...)
+
+inline char to_lower(char c) {
+    return (c >= 'A' && c <= 'Z') ? static_cast<char>(c - 'A' + 'a') : c;
+}
+
+inline bool equal_nocase(std::string_view a, std::string_view b) {
+    if (a.size() != b.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < a.size(); i++) {
+        if (to_lower(a[i]) != to_lower(b[i])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Removes leading and trailing spaces and tabs
+inline std::string_view trim(std::string_view str) {
+    while (!str.empty() && (str.front() == ' ' || str.front() == '\t')) {
+        str.remove_prefix(1);
+    }
+    while (!str.empty() && (str.back() == ' ' || str.back() == '\t')) {
+        str.remove_suffix(1);
+    }
+    return str;
+}
+
+} // namespace ascii
+} // namespace edjsamples
+
+#endif // EDJSAMPLES_ASCII_HPP
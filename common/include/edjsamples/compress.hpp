@@ -0,0 +1,448 @@
+#ifndef EDJSAMPLES_COMPRESS_HPP
+#define EDJSAMPLES_COMPRESS_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string_view>
+#include <vector>
+
+#include <zlib.h>
+
+#include <edjx/error.hpp>
+#include <edjx/stream.hpp>
+
+#include <edjsamples/ascii.hpp>
+#include <edjsamples/stream.hpp>
+
+// HTTP content codings with zlib
+//
+// The samples that include this header link zlib (see their Makefiles).
+
+namespace edjsamples {
+namespace compress {
+
+enum class Encoding {
+    Identity,
+    Gzip,
+    Deflate,
+};
+
+// Content coding name for the Content-Encoding header
+inline std::string_view to_string(Encoding encoding) {
+    switch (encoding) {
+    case Encoding::Gzip:
+        return "gzip";
+    case Encoding::Deflate:
+        return "deflate";
+    default:
+        return "identity";
+    }
+}
+
+namespace detail {
+
+// Parses a qvalue ("1", "0.5", "0.125", ...) in thousandths
+inline bool parse_qvalue(std::string_view text, int & q) {
+    if (text.empty() || (text[0] != '0' && text[0] != '1')) {
+        return false;
+    }
+    q = (text[0] - '0') * 1000;
+    if (text.size() == 1) {
+        return true;
+    }
+    if (text[1] != '.' || text.size() > 5) {
+        return false;
+    }
+    int scale = 100;
+    for (size_t i = 2; i < text.size(); i++, scale /= 10) {
+        if (text[i] < '0' || text[i] > '9') {
+            return false;
+        }
+        q += (text[i] - '0') * scale;
+    }
+    return q <= 1000;
+}
+
+} // namespace detail
+
+// Picks the coding of a response from the Accept-Encoding header of the
+// request (RFC 9110, section 12.5.3): gzip or deflate, whichever has the
+// higher qvalue (gzip if equal), or Identity if neither is acceptable.
+// "x-gzip" is gzip, "*" stands for the codings that are not listed.
+inline Encoding negotiate(std::string_view accept_encoding) {
+    int gzip_q = -1;
+    int deflate_q = -1;
+    int any_q = -1;
+
+    while (!accept_encoding.empty()) {
+        size_t end = accept_encoding.find(',');
+        std::string_view element = accept_encoding.substr(0, end);
+        accept_encoding = end == std::string_view::npos ? std::string_view() : accept_encoding.substr(end + 1);
+
+        size_t params = element.find(';');
+        std::string_view coding = ascii::trim(element.substr(0, params));
+        int q = 1000;
+        while (params != std::string_view::npos) {
+            element.remove_prefix(params + 1);
+            params = element.find(';');
+            std::string_view param = ascii::trim(element.substr(0, params));
+            if (param.size() >= 2 && ascii::to_lower(param[0]) == 'q' && param[1] == '=') {
+                if (!detail::parse_qvalue(param.substr(2), q)) {
+                    q = 0;
+                }
+            }
+        }
+
+        if (ascii::equal_nocase(coding, "gzip") || ascii::equal_nocase(coding, "x-gzip")) {
+            gzip_q = q;
+        } else if (ascii::equal_nocase(coding, "deflate")) {
+            deflate_q = q;
+        } else if (coding == "*") {
+            any_q = q;
+        }
+    }
+
+    if (gzip_q < 0) {
+        gzip_q = any_q;
+    }
+    if (deflate_q < 0) {
+        deflate_q = any_q;
+    }
+    if (gzip_q > 0 && gzip_q >= deflate_q) {
+        return Encoding::Gzip;
+    }
+    if (deflate_q > 0) {
+        return Encoding::Deflate;
+    }
+    return Encoding::Identity;
+}
+
+// Write stream that compresses the written data with gzip or deflate (zlib
+// format, as the "deflate" content coding requires)
+//
+// The memory of the compressor is bounded by `window_bits` and `mem_level`
+// (see deflateInit2() in zlib.h): with the defaults, the window and the hash
+// tables take 64 KiB instead of zlib's 256 KiB. The compressed data is
+// collected in a buffer of `pool` and written when the buffer is full, so
+// every write_chunk() of the underlying stream passes a full chunk except
+// the last one.
+//
+// valid() is false if the compressor could not be initialized; the other
+// calls then fail with StreamError::WriteFailed.
+class CompressWriteStream {
+public:
+    static const int DEFAULT_LEVEL = 6;
+    static const int DEFAULT_WINDOW_BITS = 13;
+    static const int DEFAULT_MEM_LEVEL = 6;
+
+    CompressWriteStream(
+        edjx::stream::WriteStream & stream,
+        stream::ChunkPool & pool,
+        Encoding encoding,
+        int level = DEFAULT_LEVEL,
+        int window_bits = DEFAULT_WINDOW_BITS,
+        int mem_level = DEFAULT_MEM_LEVEL
+    ) : stream(stream), pool(pool), buffer(pool.acquire()) {
+        buffer.resize(pool.capacity());
+        int format_bits = encoding == Encoding::Gzip ? window_bits + 16 : window_bits;
+        initialized = deflateInit2(&zs, level, Z_DEFLATED, format_bits, mem_level, Z_DEFAULT_STRATEGY) == Z_OK;
+        zs.next_out = buffer.data();
+        zs.avail_out = static_cast<uInt>(buffer.size());
+    }
+
+    ~CompressWriteStream() {
+        if (initialized) {
+            deflateEnd(&zs);
+        }
+        pool.release(std::move(buffer));
+    }
+
+    CompressWriteStream(const CompressWriteStream &) = delete;
+    CompressWriteStream & operator=(const CompressWriteStream &) = delete;
+
+    bool valid() const {
+        return initialized;
+    }
+
+    edjx::error::StreamError write(stream::ByteSpan data) {
+        if (!initialized) {
+            return edjx::error::StreamError::WriteFailed;
+        }
+        in_bytes += data.size;
+        zs.next_in = const_cast<Bytef *>(data.data);
+        zs.avail_in = static_cast<uInt>(data.size);
+        return deflate_input(Z_NO_FLUSH);
+    }
+
+    edjx::error::StreamError write_chunk(const std::vector<uint8_t> & chunk) {
+        return write(stream::ByteSpan(chunk.data(), chunk.size()));
+    }
+
+    // Writes the end of the compressed data and closes the stream
+    edjx::error::StreamError close() {
+        if (!initialized) {
+            stream.abort();
+            return edjx::error::StreamError::WriteFailed;
+        }
+        zs.next_in = nullptr;
+        zs.avail_in = 0;
+        edjx::error::StreamError err = deflate_input(Z_FINISH);
+        if (err == edjx::error::StreamError::Success) {
+            size_t pending = buffer.size() - zs.avail_out;
+            if (pending > 0) {
+                buffer.resize(pending);
+                out_bytes += pending;
+                err = stream.write_chunk(buffer);
+            }
+        }
+        if (err != edjx::error::StreamError::Success) {
+            stream.abort();
+            return err;
+        }
+        return stream.close();
+    }
+
+    edjx::error::StreamError abort() {
+        return stream.abort();
+    }
+
+    // Uncompressed bytes written so far
+    uint64_t bytes_in() const {
+        return in_bytes;
+    }
+
+    // Compressed bytes passed to the underlying stream so far
+    uint64_t bytes_out() const {
+        return out_bytes;
+    }
+
+private:
+    // Runs deflate() until the input is consumed (and, with Z_FINISH, the
+    // end of the stream is produced), writing every full output buffer
+    edjx::error::StreamError deflate_input(int flush) {
+        while (true) {
+            int ret = deflate(&zs, flush);
+            if (ret == Z_STREAM_ERROR) {
+                return edjx::error::StreamError::WriteFailed;
+            }
+            if (zs.avail_out == 0) {
+                out_bytes += buffer.size();
+                edjx::error::StreamError err = stream.write_chunk(buffer);
+                if (err != edjx::error::StreamError::Success) {
+                    return err;
+                }
+                zs.next_out = buffer.data();
+                zs.avail_out = static_cast<uInt>(buffer.size());
+                continue;
+            }
+            // Output space is left, so deflate() consumed all input (and
+            // finished the stream with Z_FINISH)
+            return edjx::error::StreamError::Success;
+        }
+    }
+
+    edjx::stream::WriteStream & stream;
+    stream::ChunkPool & pool;
+    std::vector<uint8_t> buffer;
+    z_stream zs = {};
+    bool initialized = false;
+    uint64_t in_bytes = 0;
+    uint64_t out_bytes = 0;
+};
+
+// Coding of a request body from its Content-Encoding header, or
+// std::nullopt for codings that are not supported (including several
+// codings applied one after another)
+inline std::optional<Encoding> parse_content_encoding(std::string_view content_encoding) {
+    content_encoding = ascii::trim(content_encoding);
+    if (content_encoding.empty() || ascii::equal_nocase(content_encoding, "identity")) {
+        return Encoding::Identity;
+    }
+    if (ascii::equal_nocase(content_encoding, "gzip") || ascii::equal_nocase(content_encoding, "x-gzip")) {
+        return Encoding::Gzip;
+    }
+    if (ascii::equal_nocase(content_encoding, "deflate")) {
+        return Encoding::Deflate;
+    }
+    return std::nullopt;
+}
+
+// Write stream that decompresses gzip or deflate (zlib format) data and
+// writes the result to `Stream` (a WriteStream, or any class with the same
+// write_chunk(const std::vector<uint8_t> &))
+//
+// The decompressed data is collected in a buffer of `pool` and written when
+// the buffer is full. At most `max_output_size` bytes are written: data that
+// decompresses to more (e.g., a decompression bomb) fails with
+// StreamError::WriteFailed and too_large() returns true. Corrupt data fails
+// with StreamError::InvalidChunk. Concatenated gzip members are decompressed
+// one after another.
+//
+// finish() writes the rest of the decompressed data and checks that the
+// compressed data is complete; it does not close `stream`.
+template <typename Stream>
+class DecompressWriteStream {
+public:
+    DecompressWriteStream(
+        Stream & stream,
+        stream::ChunkPool & pool,
+        Encoding encoding,
+        uint64_t max_output_size
+    ) : stream(stream), pool(pool), buffer(pool.acquire()),
+        gzip(encoding == Encoding::Gzip), max_output_size(max_output_size) {
+        buffer.resize(pool.capacity());
+        // The window size is chosen by the client, up to 32 KiB
+        int format_bits = gzip ? MAX_WBITS + 16 : MAX_WBITS;
+        initialized = inflateInit2(&zs, format_bits) == Z_OK;
+        zs.next_out = buffer.data();
+        zs.avail_out = static_cast<uInt>(buffer.size());
+    }
+
+    ~DecompressWriteStream() {
+        if (initialized) {
+            inflateEnd(&zs);
+        }
+        pool.release(std::move(buffer));
+    }
+
+    DecompressWriteStream(const DecompressWriteStream &) = delete;
+    DecompressWriteStream & operator=(const DecompressWriteStream &) = delete;
+
+    bool valid() const {
+        return initialized;
+    }
+
+    edjx::error::StreamError write(stream::ByteSpan data) {
+        if (err != edjx::error::StreamError::Success) {
+            return err;
+        }
+        if (!initialized) {
+            return err = edjx::error::StreamError::WriteFailed;
+        }
+        in_bytes += data.size;
+        zs.next_in = const_cast<Bytef *>(data.data);
+        zs.avail_in = static_cast<uInt>(data.size);
+        while (zs.avail_in > 0) {
+            if (ended) {
+                // Only another gzip member may follow the end of the data
+                if (!gzip || inflateReset(&zs) != Z_OK) {
+                    return err = edjx::error::StreamError::InvalidChunk;
+                }
+                ended = false;
+            }
+            int ret = inflate(&zs, Z_NO_FLUSH);
+            if (ret == Z_STREAM_END) {
+                ended = true;
+            } else if (ret != Z_OK && ret != Z_BUF_ERROR) {
+                return err = edjx::error::StreamError::InvalidChunk;
+            }
+            if (check_size() != edjx::error::StreamError::Success) {
+                return err;
+            }
+            if (zs.avail_out == 0) {
+                if (flush_buffer() != edjx::error::StreamError::Success) {
+                    return err;
+                }
+            } else if (ret == Z_BUF_ERROR) {
+                break;
+            }
+        }
+        return edjx::error::StreamError::Success;
+    }
+
+    edjx::error::StreamError write_chunk(const std::vector<uint8_t> & chunk) {
+        return write(stream::ByteSpan(chunk.data(), chunk.size()));
+    }
+
+    edjx::error::StreamError finish() {
+        if (err != edjx::error::StreamError::Success) {
+            return err;
+        }
+        if (!initialized) {
+            return err = edjx::error::StreamError::WriteFailed;
+        }
+        // inflate() may hold back output until more output space is given
+        while (!ended) {
+            int ret = inflate(&zs, Z_FINISH);
+            if (ret == Z_STREAM_END) {
+                ended = true;
+            } else if (ret != Z_BUF_ERROR || zs.avail_out != 0) {
+                // Truncated or corrupt data
+                return err = edjx::error::StreamError::InvalidChunk;
+            }
+            if (check_size() != edjx::error::StreamError::Success) {
+                return err;
+            }
+            if (zs.avail_out == 0 && flush_buffer() != edjx::error::StreamError::Success) {
+                return err;
+            }
+        }
+        size_t pending = buffer.size() - zs.avail_out;
+        if (pending > 0) {
+            buffer.resize(pending);
+            out_bytes += pending;
+            edjx::error::StreamError write_err = stream.write_chunk(buffer);
+            buffer.resize(pool.capacity());
+            zs.next_out = buffer.data();
+            zs.avail_out = static_cast<uInt>(buffer.size());
+            if (write_err != edjx::error::StreamError::Success) {
+                return err = write_err;
+            }
+        }
+        return edjx::error::StreamError::Success;
+    }
+
+    // The decompressed data exceeded `max_output_size`
+    bool too_large() const {
+        return output_too_large;
+    }
+
+    // Compressed bytes written so far
+    uint64_t bytes_in() const {
+        return in_bytes;
+    }
+
+    // Decompressed bytes passed to the underlying stream so far
+    uint64_t bytes_out() const {
+        return out_bytes;
+    }
+
+private:
+    edjx::error::StreamError check_size() {
+        if (out_bytes + (buffer.size() - zs.avail_out) > max_output_size) {
+            output_too_large = true;
+            return err = edjx::error::StreamError::WriteFailed;
+        }
+        return edjx::error::StreamError::Success;
+    }
+
+    edjx::error::StreamError flush_buffer() {
+        out_bytes += buffer.size();
+        edjx::error::StreamError write_err = stream.write_chunk(buffer);
+        if (write_err != edjx::error::StreamError::Success) {
+            return err = write_err;
+        }
+        zs.next_out = buffer.data();
+        zs.avail_out = static_cast<uInt>(buffer.size());
+        return edjx::error::StreamError::Success;
+    }
+
+    Stream & stream;
+    stream::ChunkPool & pool;
+    std::vector<uint8_t> buffer;
+    bool gzip;
+    z_stream zs = {};
+    bool initialized = false;
+    bool ended = false;
+    bool output_too_large = false;
+    uint64_t max_output_size;
+    uint64_t in_bytes = 0;
+    uint64_t out_bytes = 0;
+    edjx::error::StreamError err = edjx::error::StreamError::Success;
+};
+
+} // namespace compress
+} // namespace edjsamples
+
+#endif // EDJSAMPLES_COMPRESS_HPP
@@ -0,0 +1,173 @@
+#ifndef EDJSAMPLES_CONDITIONAL_HPP
+#define EDJSAMPLES_CONDITIONAL_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <optional>
+#include <string>
+#include <string_view>
+
+#include <edjx/http.hpp>
+#include <edjx/response.hpp>
+#include <edjx/storage.hpp>
+
+#include <edjsamples/ascii.hpp>
+#include <edjsamples/headers.hpp>
+
+namespace edjsamples {
+namespace conditional {
+
+static const edjx::http::HttpStatusCode HTTP_STATUS_NOT_MODIFIED = 304;
+
+namespace detail {
+
+// Characters allowed in an entity tag (RFC 9110, section 8.8.3)
+inline bool is_etag_char(char c) {
+    uint8_t byte = static_cast<uint8_t>(c);
+    return byte == 0x21 || (byte >= 0x23 && byte != 0x7f);
+}
+
+// Opaque part of an entity tag, without the weakness indicator
+inline std::string_view opaque_tag(std::string_view tag) {
+    if (tag.size() >= 2 && tag[0] == 'W' && tag[1] == '/') {
+        tag.remove_prefix(2);
+    }
+    return tag;
+}
+
+} // namespace detail
+
+// Strong entity tag of the current content of a file: its version
+//
+// Every upload creates a new version, so the tag changes with the content.
+// Properties are not used: any uploader can set them (e.g., a stale
+// "sha256" with new content), and a tag taken from them could answer a
+// stale copy with 304. For the same reason the entity tag is the only
+// validator: the storage does not report when a file was modified, and a
+// date stored in a property is not updated by later uploads, so
+// If-Modified-Since is not evaluated and no Last-Modified header is sent.
+//
+// Returns nullopt if the file has no version, or if it cannot be quoted.
+inline std::optional<std::string> entity_tag(const edjx::storage::FileAttributes & attributes) {
+    std::string_view opaque;
+    if (attributes.default_version_present) {
+        opaque = attributes.default_version;
+    }
+    if (opaque.empty()) {
+        return std::nullopt;
+    }
+    for (char c : opaque) {
+        if (!detail::is_etag_char(c)) {
+            return std::nullopt;
+        }
+    }
+    std::string tag;
+    tag.reserve(opaque.size() + 2);
+    tag += '"';
+    tag.append(opaque);
+    tag += '"';
+    return tag;
+}
+
+// Value of the "cache-control" property of a file, if there is one; a 304
+// response repeats the Cache-Control header of the full response
+inline std::optional<std::string_view> cache_control(const edjx::storage::FileAttributes & attributes) {
+    if (!attributes.properties_present) {
+        return std::nullopt;
+    }
+    for (const auto & property : attributes.properties) {
+        if (ascii::equal_nocase(property.first, "cache-control")) {
+            return std::string_view(property.second);
+        }
+    }
+    return std::nullopt;
+}
+
+// True if `etag` matches a member of an If-None-Match list (weak
+// comparison, RFC 9110, section 13.1.2)
+inline bool none_match_matches(std::string_view if_none_match, std::string_view etag) {
+    if_none_match = ascii::trim(if_none_match);
+    if (if_none_match == "*") {
+        return true;
+    }
+    std::string_view opaque = detail::opaque_tag(etag);
+    while (!if_none_match.empty()) {
+        size_t comma = if_none_match.find(',');
+        std::string_view member = ascii::trim(if_none_match.substr(0, comma));
+        if (!member.empty() && detail::opaque_tag(member) == opaque) {
+            return true;
+        }
+        if (comma == std::string_view::npos) {
+            break;
+        }
+        if_none_match.remove_prefix(comma + 1);
+    }
+    return false;
+}
+
+// True if a GET request can be answered with 304 Not Modified: its
+// If-None-Match matches the entity tag of the file (RFC 9110, section
+// 13.1.2). Without an entity tag of the file, the full response is sent.
+inline bool not_modified(
+    const headers::HeaderIndex & request_headers,
+    const std::optional<std::string> & etag
+) {
+    std::optional<std::string> if_none_match = request_headers.joined("if-none-match");
+    return if_none_match.has_value() && etag.has_value()
+        && none_match_matches(if_none_match.value(), etag.value());
+}
+
+// True if a Range header of the request can be honored: there is no
+// If-Range, or it is the entity tag of the file (strong comparison, RFC
+// 9110, section 13.1.5)
+//
+// A weak tag or a date in If-Range never matches (there is no date
+// validator), so a client that resumes a download of an older version gets
+// the whole current content instead of a part of it.
+inline bool range_allowed(
+    const headers::HeaderIndex & request_headers,
+    const std::optional<std::string> & etag
+) {
+    std::optional<std::string_view> if_range = request_headers.first("if-range");
+    if (!if_range.has_value()) {
+        return true;
+    }
+    return etag.has_value() && ascii::trim(if_range.value()) == etag.value();
+}
+
+// Sets the ETag header (when known) of a 200, 206, or 304 response, so
+// clients can revalidate their copy later
+inline edjx::response::HttpResponse & set_validators(
+    edjx::response::HttpResponse & res,
+    const std::optional<std::string> & etag
+) {
+    if (etag.has_value()) {
+        res.set_header("ETag", etag.value());
+    }
+    return res;
+}
+
+// 304 Not Modified response to a request for which not_modified() is true
+//
+// Repeats the entity tag and the Cache-Control header (from the
+// "cache-control" property) that the full response would have, so a client
+// refreshes the freshness of its copy (RFC 9110, section 15.4.5).
+inline edjx::response::HttpResponse not_modified_response(
+    const edjx::storage::FileAttributes & attributes,
+    const std::optional<std::string> & etag
+) {
+    edjx::response::HttpResponse res;
+    res.set_status(HTTP_STATUS_NOT_MODIFIED);
+    std::optional<std::string_view> control = cache_control(attributes);
+    if (control.has_value()) {
+        res.set_header("Cache-Control", std::string(control.value()));
+    }
+    set_validators(res, etag);
+    return res;
+}
+
+} // namespace conditional
+} // namespace edjsamples
+
+#endif // EDJSAMPLES_CONDITIONAL_HPP
@@ -0,0 +1,371 @@
+#ifndef EDJSAMPLES_DIGEST_HPP
+#define EDJSAMPLES_DIGEST_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+#include <array>
+#include <string>
+#include <vector>
+
+#if defined(__SSE4_2__) && defined(__x86_64__)
+#include <nmmintrin.h>
+#endif
+#if defined(__SHA__) && defined(__SSE4_1__)
+#include <immintrin.h>
+#endif
+
+#include <edjx/error.hpp>
+#include <edjx/stream.hpp>
+
+// Incremental checksums of streamed data
+//
+// Native x86 builds use the CRC32 instruction of SSE4.2 and the SHA
+// extensions when they are enabled (e.g., -march=native). WebAssembly
+// SIMD128 has neither a CRC nor a carry-less multiply instruction, and the
+// rounds of SHA-256 are sequential, so the WebAssembly builds use the
+// portable implementations: slicing-by-8 for CRC32C, 32-bit integer code
+// for SHA-256.
+
+namespace edjsamples {
+namespace digest {
+
+namespace detail {
+
+// Lookup tables of slicing-by-8 CRC32C (reflected polynomial 0x82F63B78)
+struct Crc32cTables {
+    uint32_t table[8][256];
+};
+
+constexpr Crc32cTables make_crc32c_tables() {
+    Crc32cTables tables{};
+    for (uint32_t i = 0; i < 256; i++) {
+        uint32_t crc = i;
+        for (int bit = 0; bit < 8; bit++) {
+            crc = (crc >> 1) ^ (0x82F63B78 & (0u - (crc & 1)));
+        }
+        tables.table[0][i] = crc;
+    }
+    for (uint32_t i = 0; i < 256; i++) {
+        for (int slice = 1; slice < 8; slice++) {
+            uint32_t prev = tables.table[slice - 1][i];
+            tables.table[slice][i] = (prev >> 8) ^ tables.table[0][prev & 0xFF];
+        }
+    }
+    return tables;
+}
+
+inline constexpr Crc32cTables CRC32C_TABLES = make_crc32c_tables();
+
+inline uint32_t crc32c_update_scalar(uint32_t crc, const uint8_t * data, size_t size) {
+    const auto & t = CRC32C_TABLES.table;
+    while (size >= 8) {
+        // Little-endian loads (WebAssembly and x86)
+        uint32_t lo;
+        uint32_t hi;
+        memcpy(&lo, data, 4);
+        memcpy(&hi, data + 4, 4);
+        lo ^= crc;
+        crc = t[7][lo & 0xFF] ^ t[6][(lo >> 8) & 0xFF] ^ t[5][(lo >> 16) & 0xFF] ^ t[4][lo >> 24]
+            ^ t[3][hi & 0xFF] ^ t[2][(hi >> 8) & 0xFF] ^ t[1][(hi >> 16) & 0xFF] ^ t[0][hi >> 24];
+        data += 8;
+        size -= 8;
+    }
+    while (size > 0) {
+        crc = (crc >> 8) ^ t[0][(crc ^ *data) & 0xFF];
+        data++;
+        size--;
+    }
+    return crc;
+}
+
+inline uint32_t crc32c_update(uint32_t crc, const uint8_t * data, size_t size) {
+#if defined(__SSE4_2__) && defined(__x86_64__)
+    uint64_t crc64 = crc;
+    while (size >= 8) {
+        uint64_t word;
+        memcpy(&word, data, 8);
+        crc64 = _mm_crc32_u64(crc64, word);
+        data += 8;
+        size -= 8;
+    }
+    crc = static_cast<uint32_t>(crc64);
+    while (size > 0) {
+        crc = _mm_crc32_u8(crc, *data);
+        data++;
+        size--;
+    }
+    return crc;
+#else
+    return crc32c_update_scalar(crc, data, size);
+#endif
+}
+
+inline constexpr uint32_t SHA256_K[64] = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+    0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+    0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+    0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+    0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+    0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2,
+};
+
+inline uint32_t rotr(uint32_t x, int n) {
+    return (x >> n) | (x << (32 - n));
+}
+
+inline void sha256_compress_scalar(uint32_t state[8], const uint8_t * blocks, size_t count) {
+    for (; count > 0; count--, blocks += 64) {
+        uint32_t w[64];
+        for (int i = 0; i < 16; i++) {
+            w[i] = static_cast<uint32_t>(blocks[4 * i]) << 24 | static_cast<uint32_t>(blocks[4 * i + 1]) << 16
+                | static_cast<uint32_t>(blocks[4 * i + 2]) << 8 | static_cast<uint32_t>(blocks[4 * i + 3]);
+        }
+        for (int i = 16; i < 64; i++) {
+            uint32_t s0 = rotr(w[i - 15], 7) ^ rotr(w[i - 15], 18) ^ (w[i - 15] >> 3);
+            uint32_t s1 = rotr(w[i - 2], 17) ^ rotr(w[i - 2], 19) ^ (w[i - 2] >> 10);
+            w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+        }
+
+        uint32_t a = state[0], b = state[1], c = state[2], d = state[3];
+        uint32_t e = state[4], f = state[5], g = state[6], h = state[7];
+        for (int i = 0; i < 64; i++) {
+            uint32_t t1 = h + (rotr(e, 6) ^ rotr(e, 11) ^ rotr(e, 25)) + ((e & f) ^ (~e & g)) + SHA256_K[i] + w[i];
+            uint32_t t2 = (rotr(a, 2) ^ rotr(a, 13) ^ rotr(a, 22)) + ((a & b) ^ (a & c) ^ (b & c));
+            h = g;
+            g = f;
+            f = e;
+            e = d + t1;
+            d = c;
+            c = b;
+            b = a;
+            a = t1 + t2;
+        }
+        state[0] += a;
+        state[1] += b;
+        state[2] += c;
+        state[3] += d;
+        state[4] += e;
+        state[5] += f;
+        state[6] += g;
+        state[7] += h;
+    }
+}
+
+#if defined(__SHA__) && defined(__SSE4_1__)
+// SHA extensions: four rounds per pair of sha256rnds2, with the state kept
+// in the ABEF/CDGH layout that the instructions use
+inline void sha256_compress_shani(uint32_t state[8], const uint8_t * blocks, size_t count) {
+    const __m128i byte_swap = _mm_set_epi64x(0x0c0d0e0f08090a0bULL, 0x0405060700010203ULL);
+
+    __m128i dcba = _mm_loadu_si128(reinterpret_cast<const __m128i *>(&state[0]));
+    __m128i hgfe = _mm_loadu_si128(reinterpret_cast<const __m128i *>(&state[4]));
+    __m128i cdab = _mm_shuffle_epi32(dcba, 0xB1);
+    __m128i efgh = _mm_shuffle_epi32(hgfe, 0x1B);
+    __m128i abef = _mm_alignr_epi8(cdab, efgh, 8);
+    __m128i cdgh = _mm_blend_epi16(efgh, cdab, 0xF0);
+
+    for (; count > 0; count--, blocks += 64) {
+        __m128i abef_start = abef;
+        __m128i cdgh_start = cdgh;
+
+        // msg[j % 4] holds the words 4j..4j+3 of the message schedule
+        __m128i msg[4];
+        for (int j = 0; j < 4; j++) {
+            msg[j] = _mm_shuffle_epi8(
+                _mm_loadu_si128(reinterpret_cast<const __m128i *>(blocks + 16 * j)), byte_swap);
+        }
+        for (int j = 0; j < 16; j++) {
+            if (j >= 4) {
+                __m128i next = _mm_sha256msg1_epu32(msg[j & 3], msg[(j + 1) & 3]);
+                next = _mm_add_epi32(next, _mm_alignr_epi8(msg[(j + 3) & 3], msg[(j + 2) & 3], 4));
+                msg[j & 3] = _mm_sha256msg2_epu32(next, msg[(j + 3) & 3]);
+            }
+            __m128i wk = _mm_add_epi32(
+                msg[j & 3], _mm_loadu_si128(reinterpret_cast<const __m128i *>(&SHA256_K[4 * j])));
+            cdgh = _mm_sha256rnds2_epu32(cdgh, abef, wk);
+            abef = _mm_sha256rnds2_epu32(abef, cdgh, _mm_shuffle_epi32(wk, 0x0E));
+        }
+
+        abef = _mm_add_epi32(abef, abef_start);
+        cdgh = _mm_add_epi32(cdgh, cdgh_start);
+    }
+
+    __m128i feba = _mm_shuffle_epi32(abef, 0x1B);
+    __m128i dchg = _mm_shuffle_epi32(cdgh, 0xB1);
+    dcba = _mm_blend_epi16(feba, dchg, 0xF0);
+    hgfe = _mm_alignr_epi8(dchg, feba, 8);
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(&state[0]), dcba);
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(&state[4]), hgfe);
+}
+#endif
+
+inline void sha256_compress(uint32_t state[8], const uint8_t * blocks, size_t count) {
+#if defined(__SHA__) && defined(__SSE4_1__)
+    sha256_compress_shani(state, blocks, count);
+#else
+    sha256_compress_scalar(state, blocks, count);
+#endif
+}
+
+} // namespace detail
+
+// Lowercase hexadecimal encoding of bytes
+inline std::string to_hex(const uint8_t * data, size_t size) {
+    static const char DIGITS[] = "0123456789abcdef";
+    std::string hex(2 * size, '0');
+    for (size_t i = 0; i < size; i++) {
+        hex[2 * i] = DIGITS[data[i] >> 4];
+        hex[2 * i + 1] = DIGITS[data[i] & 0x0F];
+    }
+    return hex;
+}
+
+// CRC32C (Castagnoli), as used by iSCSI, ext4 and cloud object stores
+class Crc32c {
+public:
+    void update(const uint8_t * data, size_t size) {
+        crc = detail::crc32c_update(crc, data, size);
+    }
+
+    void update(const std::vector<uint8_t> & data) {
+        update(data.data(), data.size());
+    }
+
+    uint32_t value() const {
+        return ~crc;
+    }
+
+    // Big-endian hexadecimal value, e.g., "e3069283" for "123456789"
+    std::string hex() const {
+        uint32_t v = value();
+        uint8_t bytes[4] = {
+            static_cast<uint8_t>(v >> 24), static_cast<uint8_t>(v >> 16),
+            static_cast<uint8_t>(v >> 8), static_cast<uint8_t>(v)
+        };
+        return to_hex(bytes, sizeof(bytes));
+    }
+
+private:
+    uint32_t crc = 0xFFFFFFFF;
+};
+
+// SHA-256 (FIPS 180-4)
+//
+// finish() pads the message and returns the digest; the object must not be
+// updated after that.
+class Sha256 {
+public:
+    static const size_t DIGEST_SIZE = 32;
+    typedef std::array<uint8_t, DIGEST_SIZE> Digest;
+
+    void update(const uint8_t * data, size_t size) {
+        total_size += size;
+        if (buffered > 0) {
+            size_t n = std::min(size, sizeof(block) - buffered);
+            memcpy(block + buffered, data, n);
+            buffered += n;
+            data += n;
+            size -= n;
+            if (buffered < sizeof(block)) {
+                return;
+            }
+            detail::sha256_compress(state, block, 1);
+            buffered = 0;
+        }
+        // Whole blocks are compressed in place, without being copied
+        size_t blocks = size / sizeof(block);
+        if (blocks > 0) {
+            detail::sha256_compress(state, data, blocks);
+            data += blocks * sizeof(block);
+            size -= blocks * sizeof(block);
+        }
+        memcpy(block, data, size);
+        buffered = size;
+    }
+
+    void update(const std::vector<uint8_t> & data) {
+        update(data.data(), data.size());
+    }
+
+    Digest finish() {
+        uint64_t bit_size = total_size * 8;
+        block[buffered++] = 0x80;
+        if (buffered > sizeof(block) - 8) {
+            memset(block + buffered, 0, sizeof(block) - buffered);
+            detail::sha256_compress(state, block, 1);
+            buffered = 0;
+        }
+        memset(block + buffered, 0, sizeof(block) - 8 - buffered);
+        for (int i = 0; i < 8; i++) {
+            block[sizeof(block) - 1 - i] = static_cast<uint8_t>(bit_size >> (8 * i));
+        }
+        detail::sha256_compress(state, block, 1);
+
+        Digest digest;
+        for (int i = 0; i < 8; i++) {
+            digest[4 * i] = static_cast<uint8_t>(state[i] >> 24);
+            digest[4 * i + 1] = static_cast<uint8_t>(state[i] >> 16);
+            digest[4 * i + 2] = static_cast<uint8_t>(state[i] >> 8);
+            digest[4 * i + 3] = static_cast<uint8_t>(state[i]);
+        }
+        return digest;
+    }
+
+private:
+    uint32_t state[8] = {
+        0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19
+    };
+    uint8_t block[64];
+    size_t buffered = 0;
+    uint64_t total_size = 0;
+};
+
+// Write stream that computes the CRC32C and SHA-256 of the chunks that pass
+// through it (e.g., from a client ReadStream to a storage WriteStream), so
+// an upload is hashed in the same pass that writes it
+//
+// `Stream` is a WriteStream or another stream with the same write_chunk(),
+// close(), and abort() (e.g., multipart::MultipartWriteStream).
+template <typename Stream = edjx::stream::WriteStream>
+class DigestWriteStream {
+public:
+    explicit DigestWriteStream(Stream & stream) : stream(stream) {}
+
+    edjx::error::StreamError write_chunk(const std::vector<uint8_t> & chunk) {
+        crc32c.update(chunk);
+        sha256.update(chunk);
+        return stream.write_chunk(chunk);
+    }
+
+    edjx::error::StreamError close() {
+        return stream.close();
+    }
+
+    edjx::error::StreamError abort() {
+        return stream.abort();
+    }
+
+    std::string crc32c_hex() const {
+        return crc32c.hex();
+    }
+
+    // Must be called once, after the last chunk
+    std::string sha256_hex() {
+        Sha256::Digest digest = sha256.finish();
+        return to_hex(digest.data(), digest.size());
+    }
+
+private:
+    Stream & stream;
+    Crc32c crc32c;
+    Sha256 sha256;
+};
+
+} // namespace digest
+} // namespace edjsamples
+
+#endif // EDJSAMPLES_DIGEST_HPP
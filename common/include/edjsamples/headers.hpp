@@ -0,0 +1,162 @@
+#ifndef EDJSAMPLES_HEADERS_HPP
+#define EDJSAMPLES_HEADERS_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <array>
+#include <algorithm>
+#include <charconv>
+#include <vector>
+#include <string>
+#include <string_view>
+#include <optional>
+
+#include <edjx/http.hpp>
+
+#include <edjsamples/ascii.hpp>
+
+namespace edjsamples {
+namespace headers {
+
+namespace detail {
+
+// FNV-1a of the lowercase name
+inline uint32_t hash_nocase(std::string_view name) {
+    uint32_t hash = 2166136261u;
+    for (char c : name) {
+        hash ^= static_cast<uint8_t>(ascii::to_lower(c));
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+} // namespace detail
+
+// Case-insensitive index of HTTP headers
+//
+// Header names are hashed once when the index is built; lookups are O(1)
+// and return views of the values in `headers`, which must outlive the index.
+// Names that differ only in case (e.g., "Authorization" and "authorization")
+// are treated as the same header. Up to INLINE_SLOTS / 2 headers are indexed
+// without heap allocation.
+class HeaderIndex {
+public:
+    static const size_t INLINE_SLOTS = 64;
+    static const size_t MIN_SLOTS = 16;
+
+    explicit HeaderIndex(const edjx::http::HttpHeaders & headers) {
+        // At most half of the slots are used, so probing stays short
+        size_t slot_count = MIN_SLOTS;
+        while (slot_count < headers.size() * 2) {
+            slot_count *= 2;
+        }
+        if (slot_count > INLINE_SLOTS) {
+            overflow_slots.resize(slot_count);
+        } else {
+            std::fill(inline_slots.begin(), inline_slots.begin() + slot_count, Slot());
+        }
+        mask = slot_count - 1;
+
+        for (const auto & header : headers) {
+            uint32_t hash = detail::hash_nocase(header.first);
+            size_t i = hash & mask;
+            while (slot(i).header != nullptr) {
+                i = (i + 1) & mask;
+            }
+            slot(i) = {hash, &header};
+        }
+    }
+
+    // The index would point into a destroyed temporary
+    explicit HeaderIndex(edjx::http::HttpHeaders && headers) = delete;
+
+    bool contains(std::string_view name) const {
+        return first(name).has_value();
+    }
+
+    // Number of values of the header
+    size_t count(std::string_view name) const {
+        size_t n = 0;
+        for_each_value(name, [&n](std::string_view) {
+            n++;
+        });
+        return n;
+    }
+
+    // First value of the header
+    std::optional<std::string_view> first(std::string_view name) const {
+        uint32_t hash = detail::hash_nocase(name);
+        for (size_t i = hash & mask; slot(i).header != nullptr; i = (i + 1) & mask) {
+            const Slot & s = slot(i);
+            if (s.hash == hash && !s.header->second.empty() && ascii::equal_nocase(s.header->first, name)) {
+                return std::string_view(s.header->second.front());
+            }
+        }
+        return {};
+    }
+
+    // Calls `f(std::string_view value)` for every value of the header
+    template <typename F>
+    void for_each_value(std::string_view name, F && f) const {
+        uint32_t hash = detail::hash_nocase(name);
+        for (size_t i = hash & mask; slot(i).header != nullptr; i = (i + 1) & mask) {
+            const Slot & s = slot(i);
+            if (s.hash == hash && ascii::equal_nocase(s.header->first, name)) {
+                for (const std::string & value : s.header->second) {
+                    f(std::string_view(value));
+                }
+            }
+        }
+    }
+
+    // All values of the header joined with `separator`
+    // (e.g., "gzip,br" for two Accept-Encoding headers "gzip" and "br")
+    std::optional<std::string> joined(std::string_view name, std::string_view separator = ",") const {
+        std::optional<std::string> result;
+        for_each_value(name, [&result, separator](std::string_view value) {
+            if (result.has_value()) {
+                result->append(separator);
+                result->append(value);
+            } else {
+                result = std::string(value);
+            }
+        });
+        return result;
+    }
+
+private:
+    struct Slot {
+        uint32_t hash;
+        const edjx::http::HttpHeaders::value_type * header; // nullptr if the slot is empty
+    };
+
+    Slot & slot(size_t i) {
+        return overflow_slots.empty() ? inline_slots[i] : overflow_slots[i];
+    }
+
+    const Slot & slot(size_t i) const {
+        return overflow_slots.empty() ? inline_slots[i] : overflow_slots[i];
+    }
+
+    std::array<Slot, INLINE_SLOTS> inline_slots; // Only the first `mask + 1` slots are initialized
+    std::vector<Slot> overflow_slots;
+    size_t mask;
+};
+
+// Value of a Content-Length header (e.g., of a storage response), or
+// nullopt if there is none or it is not a plain decimal number
+inline std::optional<uint64_t> content_length(const edjx::http::HttpHeaders & headers) {
+    HeaderIndex index(headers);
+    std::optional<std::string_view> value = index.first("content-length");
+    uint64_t size = 0;
+    if (!value.has_value() || value->empty()
+        || std::from_chars(value->data(), value->data() + value->size(), size).ptr != value->data() + value->size()) {
+        return std::nullopt;
+    }
+    return size;
+}
+
+} // namespace headers
+} // namespace edjsamples
+
+#endif // EDJSAMPLES_HEADERS_HPP
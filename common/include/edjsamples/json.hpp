@@ -0,0 +1,649 @@
+#ifndef EDJSAMPLES_JSON_HPP
+#define EDJSAMPLES_JSON_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <algorithm>
+#include <bitset>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#if defined(__wasm_simd128__)
+#include <wasm_simd128.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include <edjx/error.hpp>
+#include <edjx/stream.hpp>
+
+namespace edjsamples {
+namespace json {
+
+// Sinks of a Writer. A sink has a single member function:
+//     void write(const char * data, size_t size);
+
+// Appends to a std::string
+class StringSink {
+public:
+    explicit StringSink(std::string & out) : out(out) {}
+
+    void write(const char * data, size_t size) {
+        out.append(data, size);
+    }
+
+private:
+    std::string & out;
+};
+
+// Counts the bytes instead of writing them
+// (to pre-size the output buffer with a first pass)
+class CountingSink {
+public:
+    void write(const char *, size_t size) {
+        count += size;
+    }
+
+    size_t size() const {
+        return count;
+    }
+
+private:
+    size_t count = 0;
+};
+
+// Writes to a WriteStream in chunks of `chunk_size` bytes.
+// flush() must be called at the end; the first write error is kept
+// and later writes are ignored.
+class StreamSink {
+public:
+    explicit StreamSink(edjx::stream::WriteStream & stream, size_t chunk_size = 4096)
+        : stream(stream), chunk_size(chunk_size) {
+        buffer.reserve(chunk_size);
+    }
+
+    void write(const char * data, size_t size) {
+        while (size > 0 && err == edjx::error::StreamError::Success) {
+            size_t n = std::min(size, chunk_size - buffer.size());
+            buffer.insert(buffer.end(), data, data + n);
+            data += n;
+            size -= n;
+            if (buffer.size() == chunk_size) {
+                flush();
+            }
+        }
+    }
+
+    edjx::error::StreamError flush() {
+        if (err == edjx::error::StreamError::Success && !buffer.empty()) {
+            err = stream.write_chunk(buffer);
+            buffer.clear();
+        }
+        return err;
+    }
+
+    edjx::error::StreamError error() const {
+        return err;
+    }
+
+private:
+    edjx::stream::WriteStream & stream;
+    size_t chunk_size;
+    std::vector<uint8_t> buffer;
+    edjx::error::StreamError err = edjx::error::StreamError::Success;
+};
+
+namespace detail {
+
+inline bool needs_escape(char c) {
+    return static_cast<unsigned char>(c) < 0x20 || c == '"' || c == '\\';
+}
+
+inline size_t find_escape_scalar(const char * data, size_t size) {
+    for (size_t i = 0; i < size; i++) {
+        if (needs_escape(data[i])) {
+            return i;
+        }
+    }
+    return size;
+}
+
+// Index of the first byte of `data` that needs to be escaped, or `size`.
+// Checks 16 bytes at a time with WebAssembly SIMD128 (-msimd128),
+// or with SSE2 in native builds.
+inline size_t find_escape(const char * data, size_t size) {
+    size_t i = 0;
+#if defined(__wasm_simd128__)
+    const v128_t control_limit = wasm_u8x16_splat(0x20);
+    const v128_t quote = wasm_u8x16_splat('"');
+    const v128_t backslash = wasm_u8x16_splat('\\');
+    for (; i + 16 <= size; i += 16) {
+        v128_t chunk = wasm_v128_load(data + i);
+        v128_t special = wasm_v128_or(
+            wasm_u8x16_lt(chunk, control_limit),
+            wasm_v128_or(wasm_i8x16_eq(chunk, quote), wasm_i8x16_eq(chunk, backslash))
+        );
+        uint32_t mask = wasm_i8x16_bitmask(special);
+        if (mask != 0) {
+            return i + __builtin_ctz(mask);
+        }
+    }
+#elif defined(__SSE2__)
+    // SSE2 has no unsigned byte compare: c < 0x20 <=> max(c, 0x1f) == 0x1f
+    const __m128i control_max = _mm_set1_epi8(0x1f);
+    const __m128i quote = _mm_set1_epi8('"');
+    const __m128i backslash = _mm_set1_epi8('\\');
+    for (; i + 16 <= size; i += 16) {
+        __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + i));
+        __m128i special = _mm_or_si128(
+            _mm_cmpeq_epi8(_mm_max_epu8(chunk, control_max), control_max),
+            _mm_or_si128(_mm_cmpeq_epi8(chunk, quote), _mm_cmpeq_epi8(chunk, backslash))
+        );
+        uint32_t mask = static_cast<uint32_t>(_mm_movemask_epi8(special));
+        if (mask != 0) {
+            return i + __builtin_ctz(mask);
+        }
+    }
+#endif
+    return i + find_escape_scalar(data + i, size - i);
+}
+
+// Writes the escape sequence of `c` (needs_escape(c) is true)
+template <typename Sink>
+void write_escape(Sink & sink, char c) {
+    switch (c) {
+        case '"': sink.write("\\\"", 2); return;
+        case '\\': sink.write("\\\\", 2); return;
+        case '\b': sink.write("\\b", 2); return;
+        case '\f': sink.write("\\f", 2); return;
+        case '\n': sink.write("\\n", 2); return;
+        case '\r': sink.write("\\r", 2); return;
+        case '\t': sink.write("\\t", 2); return;
+    }
+    // Other control characters
+    static const char HEX[] = "0123456789abcdef";
+    unsigned char byte = static_cast<unsigned char>(c);
+    char escape[6] = {'\\', 'u', '0', '0', HEX[byte >> 4], HEX[byte & 0xf]};
+    sink.write(escape, sizeof(escape));
+}
+
+} // namespace detail
+
+// Writes `value` as the contents of a JSON string (without the quotes).
+// Runs of bytes that do not need escaping are written in one call;
+// control characters without a short escape are written as \u00XX.
+template <typename Sink>
+void write_escaped(Sink & sink, std::string_view value) {
+    // JSON specification is at https://www.json.org
+    const char * data = value.data();
+    size_t size = value.size();
+    while (size > 0) {
+        size_t clean = detail::find_escape(data, size);
+        if (clean > 0) {
+            sink.write(data, clean);
+        }
+        if (clean == size) {
+            break;
+        }
+        detail::write_escape(sink, data[clean]);
+        data += clean + 1;
+        size -= clean + 1;
+    }
+}
+
+// Minimal JSON writer. Keeps track of the commas between members and
+// elements; the caller is responsible for a well-formed structure
+// (e.g., key() before every value inside an object). Supports nesting
+// up to 64 levels.
+template <typename Sink>
+class Writer {
+public:
+    explicit Writer(Sink & sink) : sink(sink) {}
+
+    void begin_object() {
+        begin_value();
+        write("{", 1);
+        push();
+    }
+
+    void end_object() {
+        pop();
+        write("}", 1);
+    }
+
+    void begin_array() {
+        begin_value();
+        write("[", 1);
+        push();
+    }
+
+    void end_array() {
+        pop();
+        write("]", 1);
+    }
+
+    void key(std::string_view name) {
+        begin_value();
+        write_string(name);
+        write(":", 1);
+        after_key = true;
+    }
+
+    void string(std::string_view value) {
+        begin_value();
+        write_string(value);
+    }
+
+    void null() {
+        begin_value();
+        write("null", 4);
+    }
+
+private:
+    void write(const char * data, size_t size) {
+        sink.write(data, size);
+    }
+
+    void write_string(std::string_view value) {
+        write("\"", 1);
+        write_escaped(sink, value);
+        write("\"", 1);
+    }
+
+    // Writes the comma before every member or element except the first one
+    void begin_value() {
+        if (after_key) {
+            after_key = false;
+            return;
+        }
+        if (depth > 0) {
+            uint64_t bit = uint64_t(1) << (depth - 1);
+            if (has_members & bit) {
+                write(",", 1);
+            }
+            has_members |= bit;
+        }
+    }
+
+    void push() {
+        depth++;
+        has_members &= ~(uint64_t(1) << (depth - 1));
+    }
+
+    void pop() {
+        depth--;
+    }
+
+    Sink & sink;
+    unsigned depth = 0;
+    uint64_t has_members = 0; // Bit n: the container at depth n + 1 has a member
+    bool after_key = false;
+};
+
+// Incremental JSON validator (RFC 8259)
+//
+// The input is fed in chunks as it is received, e.g., from
+// ReadStream::read_chunk(); feed() returns false as soon as the input
+// cannot be the beginning of a valid JSON text, so the rest of it does not
+// have to be read. Memory use is constant: nesting is tracked with a bit
+// stack of MAX_DEPTH levels, and deeper input is rejected. Input longer than
+// `max_size` bytes is rejected before it is parsed. UTF-8 in strings is not
+// validated.
+class Validator {
+public:
+    static const size_t MAX_DEPTH = 256;
+
+    explicit Validator(size_t max_size = SIZE_MAX) : max_size(max_size) {}
+
+    // Validates the next chunk of the input
+    bool feed(const uint8_t * data, size_t size) {
+        if (state == State::Error) {
+            return false;
+        }
+        if (size > max_size - total) {
+            exceeded_max_size = true;
+            return fail(max_size);
+        }
+        const char * chars = reinterpret_cast<const char *>(data);
+        for (size_t i = 0; i < size; i++) {
+            if (state == State::String) {
+                // Skip to the closing quote, escape, or invalid character
+                i += detail::find_escape(chars + i, size - i);
+                if (i == size) {
+                    break;
+                }
+            }
+            if (!step(chars[i])) {
+                return fail(total + i);
+            }
+        }
+        total += size;
+        return true;
+    }
+
+    bool feed(const std::vector<uint8_t> & chunk) {
+        return feed(chunk.data(), chunk.size());
+    }
+
+    // Validates the end of the input, returns true if the whole input
+    // was a single JSON value
+    bool finish() {
+        if (state == State::Error) {
+            return false;
+        }
+        // A number at the top level ends with the input
+        if (!step(' ') || state != State::Done) {
+            return fail(total);
+        }
+        return true;
+    }
+
+    // Number of bytes fed so far
+    size_t size() const {
+        return total;
+    }
+
+    // Deepest nesting of objects and arrays seen so far
+    size_t max_depth() const {
+        return deepest;
+    }
+
+    bool failed() const {
+        return state == State::Error;
+    }
+
+    // Offset of the first invalid byte (the input size if it ended too early)
+    size_t error_offset() const {
+        return error_at;
+    }
+
+    // The input was rejected because it is longer than `max_size`
+    bool too_large() const {
+        return exceeded_max_size;
+    }
+
+private:
+    enum class State {
+        Value,          // Any value
+        ArrayFirst,     // Value or ']' after '['
+        ObjectFirst,    // Key or '}' after '{'
+        ObjectKey,      // Key after ','
+        Colon,          // ':' after a key
+        AfterValue,     // ',' or the end of the container
+        String,
+        StringEscape,   // After '\'
+        StringUnicode,  // Hex digits of \uXXXX
+        Minus,
+        Zero,
+        Integer,
+        Dot,
+        Fraction,
+        Exponent,       // After 'e' or 'E'
+        ExponentSign,
+        ExponentDigits,
+        Literal,        // true, false, null
+        Done,           // Only whitespace may follow
+        Error
+    };
+
+    static bool is_space(char c) {
+        return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+    }
+
+    static bool is_digit(char c) {
+        return c >= '0' && c <= '9';
+    }
+
+    static bool is_hex_digit(char c) {
+        return is_digit(c) || (c >= 'a' && c <= 'f') || (c >= 'A' && c <= 'F');
+    }
+
+    bool fail(size_t offset) {
+        state = State::Error;
+        error_at = offset;
+        return false;
+    }
+
+    bool step(char c) {
+        switch (state) {
+            case State::Value:
+            case State::ArrayFirst:
+                if (is_space(c)) {
+                    return true;
+                }
+                if (c == ']' && state == State::ArrayFirst) {
+                    return close();
+                }
+                return begin_value(c);
+            case State::ObjectFirst:
+            case State::ObjectKey:
+                if (is_space(c)) {
+                    return true;
+                }
+                if (c == '}' && state == State::ObjectFirst) {
+                    return close();
+                }
+                if (c == '"') {
+                    in_key = true;
+                    state = State::String;
+                    return true;
+                }
+                return false;
+            case State::Colon:
+                if (is_space(c)) {
+                    return true;
+                }
+                if (c == ':') {
+                    state = State::Value;
+                    return true;
+                }
+                return false;
+            case State::AfterValue:
+                if (is_space(c)) {
+                    return true;
+                }
+                if (c == ',') {
+                    state = in_object() ? State::ObjectKey : State::Value;
+                    return true;
+                }
+                if (c == (in_object() ? '}' : ']')) {
+                    return close();
+                }
+                return false;
+            case State::String:
+                if (c == '"') {
+                    if (in_key) {
+                        in_key = false;
+                        state = State::Colon;
+                    } else {
+                        end_value();
+                    }
+                    return true;
+                }
+                if (c == '\\') {
+                    state = State::StringEscape;
+                    return true;
+                }
+                return static_cast<unsigned char>(c) >= 0x20;
+            case State::StringEscape:
+                switch (c) {
+                    case '"': case '\\': case '/': case 'b': case 'f': case 'n': case 'r': case 't':
+                        state = State::String;
+                        return true;
+                    case 'u':
+                        hex_digits = 0;
+                        state = State::StringUnicode;
+                        return true;
+                    default:
+                        return false;
+                }
+            case State::StringUnicode:
+                if (!is_hex_digit(c)) {
+                    return false;
+                }
+                if (++hex_digits == 4) {
+                    state = State::String;
+                }
+                return true;
+            case State::Minus:
+                if (c == '0') {
+                    state = State::Zero;
+                    return true;
+                }
+                if (is_digit(c)) {
+                    state = State::Integer;
+                    return true;
+                }
+                return false;
+            case State::Zero:
+            case State::Integer:
+                if (is_digit(c) && state == State::Integer) {
+                    return true;
+                }
+                if (c == '.') {
+                    state = State::Dot;
+                    return true;
+                }
+                if (c == 'e' || c == 'E') {
+                    state = State::Exponent;
+                    return true;
+                }
+                return end_number(c);
+            case State::Dot:
+                if (is_digit(c)) {
+                    state = State::Fraction;
+                    return true;
+                }
+                return false;
+            case State::Fraction:
+                if (is_digit(c)) {
+                    return true;
+                }
+                if (c == 'e' || c == 'E') {
+                    state = State::Exponent;
+                    return true;
+                }
+                return end_number(c);
+            case State::Exponent:
+                if (c == '+' || c == '-') {
+                    state = State::ExponentSign;
+                    return true;
+                }
+                if (is_digit(c)) {
+                    state = State::ExponentDigits;
+                    return true;
+                }
+                return false;
+            case State::ExponentSign:
+                if (is_digit(c)) {
+                    state = State::ExponentDigits;
+                    return true;
+                }
+                return false;
+            case State::ExponentDigits:
+                if (is_digit(c)) {
+                    return true;
+                }
+                return end_number(c);
+            case State::Literal:
+                if (c != *literal) {
+                    return false;
+                }
+                if (*++literal == '\0') {
+                    end_value();
+                }
+                return true;
+            case State::Done:
+                return is_space(c);
+            case State::Error:
+                return false;
+        }
+        return false;
+    }
+
+    bool begin_value(char c) {
+        switch (c) {
+            case '{':
+                state = State::ObjectFirst;
+                return open(true);
+            case '[':
+                state = State::ArrayFirst;
+                return open(false);
+            case '"':
+                state = State::String;
+                return true;
+            case '-':
+                state = State::Minus;
+                return true;
+            case '0':
+                state = State::Zero;
+                return true;
+            case 't':
+                return begin_literal("rue");
+            case 'f':
+                return begin_literal("alse");
+            case 'n':
+                return begin_literal("ull");
+            default:
+                if (is_digit(c)) {
+                    state = State::Integer;
+                    return true;
+                }
+                return false;
+        }
+    }
+
+    bool begin_literal(const char * rest) {
+        literal = rest;
+        state = State::Literal;
+        return true;
+    }
+
+    // `c` is the first byte after the number
+    bool end_number(char c) {
+        end_value();
+        return step(c);
+    }
+
+    void end_value() {
+        state = depth == 0 ? State::Done : State::AfterValue;
+    }
+
+    bool open(bool object) {
+        if (depth == MAX_DEPTH) {
+            return false;
+        }
+        containers[depth] = object;
+        depth++;
+        deepest = std::max(deepest, depth);
+        return true;
+    }
+
+    bool close() {
+        depth--;
+        end_value();
+        return true;
+    }
+
+    bool in_object() const {
+        return containers[depth - 1];
+    }
+
+    State state = State::Value;
+    std::bitset<MAX_DEPTH> containers; // Bit n: the container at depth n + 1 is an object
+    size_t depth = 0;
+    size_t deepest = 0;
+    bool in_key = false;
+    unsigned hex_digits = 0;
+    const char * literal = nullptr; // Rest of the literal being matched
+    size_t total = 0;
+    size_t max_size;
+    size_t error_at = 0;
+    bool exceeded_max_size = false;
+};
+
+} // namespace json
+} // namespace edjsamples
+
+#endif // EDJSAMPLES_JSON_HPP
@@ -0,0 +1,196 @@
+#ifndef EDJSAMPLES_KV_CACHE_HPP
+#define EDJSAMPLES_KV_CACHE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <edjx/logger.hpp>
+#include <edjx/storage.hpp>
+
+namespace edjsamples {
+namespace kv_cache {
+
+// KV key of a cached copy of something stored with a file, e.g.,
+// "object:<bucket_id>:<version>:<file_name>"
+//
+// Bucket IDs and versions do not contain ':', so the file name (which may
+// contain anything) is the last part and keys of different files never
+// collide. `version` is empty for entries that are not tied to a version.
+inline std::string key(
+    std::string_view kind,
+    std::string_view bucket_id,
+    std::string_view version,
+    std::string_view file_name
+) {
+    std::string result;
+    result.reserve(kind.size() + bucket_id.size() + version.size() + file_name.size() + 3);
+    result.append(kind);
+    result += ':';
+    result.append(bucket_id);
+    result += ':';
+    result.append(version);
+    result += ':';
+    result.append(file_name);
+    return result;
+}
+
+// Logs whether a request was served from the cache ("kv cache: hits=1
+// misses=0 fills=0"); a function instance keeps no state between requests,
+// so the counters are logged once per request and summed from the logs
+inline void log_counters(bool hit, bool filled) {
+    edjx::logger::info(std::string("kv cache: hits=") + (hit ? "1" : "0")
+        + " misses=" + (hit ? "0" : "1")
+        + " fills=" + (filled ? "1" : "0"));
+}
+
+// Builds a compact binary KV value: unsigned integers as LEB128 varints and
+// byte strings prefixed with their length
+class Encoder {
+public:
+    void put_uint(uint64_t value) {
+        while (value >= 0x80) {
+            buffer.push_back(static_cast<uint8_t>(value | 0x80));
+            value >>= 7;
+        }
+        buffer.push_back(static_cast<uint8_t>(value));
+    }
+
+    void put_bytes(const uint8_t * data, size_t size) {
+        put_uint(size);
+        buffer.insert(buffer.end(), data, data + size);
+    }
+
+    void put_bytes(std::string_view bytes) {
+        put_bytes(reinterpret_cast<const uint8_t *>(bytes.data()), bytes.size());
+    }
+
+    void reserve(size_t size) {
+        buffer.reserve(size);
+    }
+
+    const std::vector<uint8_t> & bytes() const {
+        return buffer;
+    }
+
+private:
+    std::vector<uint8_t> buffer;
+};
+
+// Reads a value built by Encoder, in the same order
+//
+// Returned views point into `bytes`, which must outlive the decoder. Every
+// get fails (returns false) once the value turns out to be truncated or
+// malformed, so a corrupt entry can be treated as a cache miss.
+class Decoder {
+public:
+    explicit Decoder(const std::vector<uint8_t> & bytes)
+        : position(bytes.data()), end(bytes.data() + bytes.size()) {}
+
+    bool get_uint(uint64_t & value) {
+        value = 0;
+        if (failed) {
+            return false;
+        }
+        for (unsigned shift = 0; shift < 64; shift += 7) {
+            if (position == end) {
+                return fail();
+            }
+            uint8_t byte = *position++;
+            value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+            if ((byte & 0x80) == 0) {
+                return true;
+            }
+        }
+        return fail();
+    }
+
+    bool get_bytes(std::string_view & bytes) {
+        uint64_t size;
+        if (!get_uint(size)) {
+            return false;
+        }
+        if (size > static_cast<uint64_t>(end - position)) {
+            return fail();
+        }
+        bytes = std::string_view(reinterpret_cast<const char *>(position), size);
+        position += size;
+        return true;
+    }
+
+    // True when the whole value was read without errors
+    bool done() const {
+        return !failed && position == end;
+    }
+
+private:
+    bool fail() {
+        failed = true;
+        position = end;
+        return false;
+    }
+
+    const uint8_t * position;
+    const uint8_t * end;
+    bool failed = false;
+};
+
+// Format of the cached FileAttributes; change it when the encoding changes
+static const uint64_t ATTRIBUTES_FORMAT = 1;
+
+// KV key of the cached attributes of a file; the attributes include the
+// version, so the key does not
+inline std::string attributes_key(std::string_view bucket_id, std::string_view file_name) {
+    return key("attributes", bucket_id, std::string_view(), file_name);
+}
+
+// FileAttributes as a KV value: the format, flags (1 = properties present,
+// 2 = default version present), the properties, and the default version
+inline std::vector<uint8_t> encode_attributes(const edjx::storage::FileAttributes & attributes) {
+    Encoder encoder;
+    encoder.put_uint(ATTRIBUTES_FORMAT);
+    encoder.put_uint((attributes.properties_present ? 1 : 0) | (attributes.default_version_present ? 2 : 0));
+    encoder.put_uint(attributes.properties.size());
+    for (const auto & property : attributes.properties) {
+        encoder.put_bytes(property.first);
+        encoder.put_bytes(property.second);
+    }
+    encoder.put_bytes(attributes.default_version);
+    return encoder.bytes();
+}
+
+// Returns false if the value is corrupt or in another format
+inline bool decode_attributes(const std::vector<uint8_t> & value, edjx::storage::FileAttributes & attributes) {
+    Decoder decoder(value);
+    uint64_t format;
+    uint64_t flags;
+    uint64_t property_count;
+    if (!decoder.get_uint(format) || format != ATTRIBUTES_FORMAT
+        || !decoder.get_uint(flags) || !decoder.get_uint(property_count)) {
+        return false;
+    }
+    attributes.properties.clear();
+    for (uint64_t i = 0; i < property_count; i++) {
+        std::string_view name;
+        std::string_view property_value;
+        if (!decoder.get_bytes(name) || !decoder.get_bytes(property_value)) {
+            return false;
+        }
+        attributes.properties.emplace(name, property_value);
+    }
+    std::string_view version;
+    if (!decoder.get_bytes(version) || !decoder.done()) {
+        return false;
+    }
+    attributes.properties_present = (flags & 1) != 0;
+    attributes.default_version_present = (flags & 2) != 0;
+    attributes.default_version = std::string(version);
+    return true;
+}
+
+} // namespace kv_cache
+} // namespace edjsamples
+
+#endif // EDJSAMPLES_KV_CACHE_HPP
@@ -0,0 +1,130 @@
+#ifndef EDJSAMPLES_MEDIA_TYPE_HPP
+#define EDJSAMPLES_MEDIA_TYPE_HPP
+
+#include <cstddef>
+#include <string_view>
+#include <optional>
+
+#include <edjsamples/ascii.hpp>
+
+namespace edjsamples {
+namespace media_type {
+
+namespace detail {
+
+// tchar of RFC 9110
+inline bool is_token_char(char c) {
+    if ((c >= '0' && c <= '9') || (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z')) {
+        return true;
+    }
+    switch (c) {
+        case '!': case '#': case '$': case '%': case '&': case '\'': case '*':
+        case '+': case '-': case '.': case '^': case '_': case '`': case '|': case '~':
+            return true;
+        default:
+            return false;
+    }
+}
+
+inline bool is_token(std::string_view str) {
+    if (str.empty()) {
+        return false;
+    }
+    for (char c : str) {
+        if (!is_token_char(c)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace detail
+
+// Media type of a Content-Type header, e.g., "application/json; charset=utf-8"
+//
+// All fields are slices of the parsed header value. Type, subtype and
+// parameter names are case-insensitive.
+struct MediaType {
+    std::string_view type;
+    std::string_view subtype;
+    std::string_view parameters; // Everything after the first ';'
+
+    bool is(std::string_view expected_type, std::string_view expected_subtype) const {
+        return ascii::equal_nocase(type, expected_type) && ascii::equal_nocase(subtype, expected_subtype);
+    }
+
+    // Value of the parameter `name` (e.g., "charset"). Quotes around
+    // the value are removed; quoted values with escapes are returned as-is.
+    std::optional<std::string_view> parameter(std::string_view name) const {
+        std::string_view rest = parameters;
+        while (!rest.empty()) {
+            size_t end = rest.find(';');
+            std::string_view parameter = ascii::trim(rest.substr(0, end));
+            size_t separator = parameter.find('=');
+            if (separator != std::string_view::npos && ascii::equal_nocase(ascii::trim(parameter.substr(0, separator)), name)) {
+                std::string_view value = ascii::trim(parameter.substr(separator + 1));
+                if (value.size() >= 2 && value.front() == '"' && value.back() == '"'
+                        && value.find('\\') == std::string_view::npos) {
+                    value = value.substr(1, value.size() - 2);
+                }
+                return value;
+            }
+            if (end == std::string_view::npos) {
+                break;
+            }
+            rest.remove_prefix(end + 1);
+        }
+        return {};
+    }
+};
+
+// Parses a Content-Type header value, returns std::nullopt if it is not
+// a valid "type/subtype" (parameters are validated lazily by parameter())
+inline std::optional<MediaType> parse(std::string_view value) {
+    MediaType media_type;
+    size_t parameters_start = value.find(';');
+    std::string_view essence = ascii::trim(value.substr(0, parameters_start));
+    if (parameters_start != std::string_view::npos) {
+        media_type.parameters = value.substr(parameters_start + 1);
+    }
+
+    size_t slash = essence.find('/');
+    if (slash == std::string_view::npos) {
+        return {};
+    }
+    media_type.type = essence.substr(0, slash);
+    media_type.subtype = essence.substr(slash + 1);
+    if (!detail::is_token(media_type.type) || !detail::is_token(media_type.subtype)) {
+        return {};
+    }
+    return media_type;
+}
+
+// Entry of a media type dispatch table, e.g.,
+//
+//     static constexpr Route<BodyHandler> ROUTES[] = {
+//         {"application", "json", handle_json},
+//         {"text", "plain", handle_text},
+//     };
+template <typename Handler>
+struct Route {
+    std::string_view type;
+    std::string_view subtype;
+    Handler handler;
+};
+
+// Route of `media_type` in `routes`, or nullptr if there is none
+template <typename Handler, size_t N>
+const Route<Handler> * find_route(const Route<Handler> (& routes)[N], const MediaType & media_type) {
+    for (const Route<Handler> & route : routes) {
+        if (media_type.is(route.type, route.subtype)) {
+            return &route;
+        }
+    }
+    return nullptr;
+}
+
+} // namespace media_type
+} // namespace edjsamples
+
+#endif // EDJSAMPLES_MEDIA_TYPE_HPP
@@ -0,0 +1,529 @@
+#ifndef EDJSAMPLES_MULTIPART_HPP
+#define EDJSAMPLES_MULTIPART_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <deque>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include <edjx/error.hpp>
+#include <edjx/storage.hpp>
+#include <edjx/stream.hpp>
+
+#include <edjsamples/digest.hpp>
+
+namespace edjsamples {
+namespace multipart {
+
+// Property set (value "1") on the manifest of a multipart upload
+//
+// The property only tells other tools (e.g., edjstorage-get-attributes)
+// that the file is a manifest. Any uploader can set or drop properties, so
+// a manifest is recognized by its content: the MANIFEST_MAGIC first line
+// and a valid format (see looks_like_manifest() and parse()).
+static const char MANIFEST_PROPERTY[] = "multipart-manifest";
+
+// First line of a manifest, with the version of the format
+static const std::string_view MANIFEST_MAGIC = "edjsamples-multipart-manifest 1";
+
+// Manifests are read into memory; a file larger than this is never one.
+// With 8 MiB parts, a manifest of this size lists over 100 GiB of content.
+static const size_t MAX_MANIFEST_SIZE = 1024 * 1024;
+
+// A part of a multipart file, stored as a separate object
+struct Part {
+    uint64_t size = 0;
+    uint32_t crc32c = 0;
+    std::string name;
+};
+
+// Manifest of a multipart file: the parts in the order of their content
+//
+// The text format is MANIFEST_MAGIC, a "size <bytes>" line with the size of
+// the whole content, and a "<size> <crc32c hex> <name>" line per part:
+//
+//     edjsamples-multipart-manifest 1
+//     size 20971520
+//     8388608 1f2e3d4c report.csv.parts/17a4c6e0f0b3d000/0
+//     8388608 5a6b7c8d report.csv.parts/17a4c6e0f0b3d000/1
+//     4194304 0a1b2c3d report.csv.parts/17a4c6e0f0b3d000/2
+struct Manifest {
+    uint64_t size = 0;
+    std::vector<Part> parts;
+};
+
+namespace detail {
+
+inline bool parse_uint(std::string_view text, uint64_t & value, int base = 10) {
+    if (text.empty()) {
+        return false;
+    }
+    std::from_chars_result result = std::from_chars(text.data(), text.data() + text.size(), value, base);
+    return result.ec == std::errc() && result.ptr == text.data() + text.size();
+}
+
+inline std::string crc32c_hex(uint32_t crc) {
+    const uint8_t bytes[4] = {
+        static_cast<uint8_t>(crc >> 24), static_cast<uint8_t>(crc >> 16),
+        static_cast<uint8_t>(crc >> 8), static_cast<uint8_t>(crc)
+    };
+    return digest::to_hex(bytes, sizeof(bytes));
+}
+
+// True if `name` is a part name that MultipartWriteStream gives the parts
+// of `file_name`: "<file_name>.parts/<upload id (hex)>/<index>"
+inline bool is_part_name(std::string_view name, std::string_view file_name) {
+    static const std::string_view SUFFIX = ".parts/";
+    if (name.size() <= file_name.size() + SUFFIX.size() || name.substr(0, file_name.size()) != file_name
+        || name.substr(file_name.size(), SUFFIX.size()) != SUFFIX) {
+        return false;
+    }
+    name.remove_prefix(file_name.size() + SUFFIX.size());
+    size_t slash = name.find('/');
+    uint64_t value;
+    return slash != std::string_view::npos
+        && parse_uint(name.substr(0, slash), value, 16)
+        && parse_uint(name.substr(slash + 1), value);
+}
+
+} // namespace detail
+
+// True if `head`, the beginning of a file, can be the beginning of a
+// manifest: it is a prefix of the MANIFEST_MAGIC line or starts with it.
+// A reader collects the content until this is false, or until the file
+// ends and parse() decides.
+inline bool looks_like_manifest(std::string_view head) {
+    if (head.size() > MANIFEST_MAGIC.size()) {
+        return head.substr(0, MANIFEST_MAGIC.size()) == MANIFEST_MAGIC && head[MANIFEST_MAGIC.size()] == '\n';
+    }
+    return MANIFEST_MAGIC.substr(0, head.size()) == head;
+}
+
+inline std::string format(const Manifest & manifest) {
+    std::string text;
+    text.reserve(64 + manifest.parts.size() * 64);
+    text.append(MANIFEST_MAGIC);
+    text += "\nsize ";
+    text += std::to_string(manifest.size);
+    text += '\n';
+    for (const Part & part : manifest.parts) {
+        text += std::to_string(part.size);
+        text += ' ';
+        text += detail::crc32c_hex(part.crc32c);
+        text += ' ';
+        text += part.name;
+        text += '\n';
+    }
+    return text;
+}
+
+// Parses the manifest stored as the file `file_name`
+//
+// Returns false if the text is not a manifest in the format above, if the
+// sizes of the parts do not add up to the size of the content, or if a part
+// is not named like a part of `file_name` ("<file_name>.parts/..."). Any
+// client can upload text in this format, so a manifest must not make a
+// reader send (or a writer remove) other objects of the bucket.
+inline bool parse(std::string_view text, std::string_view file_name, Manifest & manifest) {
+    manifest = Manifest();
+    bool size_present = false;
+    uint64_t total = 0;
+    size_t line_number = 0;
+    while (!text.empty()) {
+        size_t newline = text.find('\n');
+        if (newline == std::string_view::npos) {
+            return false;
+        }
+        std::string_view line = text.substr(0, newline);
+        text.remove_prefix(newline + 1);
+
+        if (line_number++ == 0) {
+            if (line != MANIFEST_MAGIC) {
+                return false;
+            }
+        } else if (!size_present) {
+            if (line.substr(0, 5) != "size " || !detail::parse_uint(line.substr(5), manifest.size)) {
+                return false;
+            }
+            size_present = true;
+        } else {
+            size_t first_space = line.find(' ');
+            size_t second_space = line.find(' ', first_space == std::string_view::npos ? 0 : first_space + 1);
+            uint64_t crc;
+            Part part;
+            if (second_space == std::string_view::npos
+                || !detail::parse_uint(line.substr(0, first_space), part.size)
+                || second_space - first_space - 1 != 8
+                || !detail::parse_uint(line.substr(first_space + 1, 8), crc, 16)
+                || second_space + 1 == line.size()) {
+                return false;
+            }
+            part.crc32c = static_cast<uint32_t>(crc);
+            part.name = std::string(line.substr(second_space + 1));
+            if (!detail::is_part_name(part.name, file_name)) {
+                return false;
+            }
+            if (part.size > UINT64_MAX - total) {
+                return false;
+            }
+            total += part.size;
+            manifest.parts.push_back(std::move(part));
+        }
+    }
+    return size_present && total == manifest.size;
+}
+
+// Write stream that uploads content to the storage in parts of `part_size`
+// bytes and a manifest
+//
+// Every part is a separate put_streaming() upload named
+// "<file_name>.parts/<upload id>/<index>". When a part is full, its stream
+// is closed and the next part is opened without waiting for the storage to
+// confirm the previous one; up to `max_in_flight` part uploads are pending
+// at a time, so the storage commits earlier parts while the next ones are
+// written. close() waits for all of them and then uploads the manifest
+// (with the MANIFEST_PROPERTY property) under `file_name` itself, so the
+// manifest replaces the previous version of the file only once every part
+// is stored.
+//
+// With `part_size` 0, the content is uploaded as a single object named
+// `file_name`, as with put_streaming().
+//
+// Parts are removed when they are no longer referenced: if the file was a
+// manifest when open() was called, the parts it lists are removed once
+// get_storage_response() confirms the upload that replaced it; if the upload
+// fails or is aborted, the parts it stored are removed. Only objects under
+// "<file_name>.parts/" are removed: parse() rejects a manifest that lists
+// anything else. A download that is reading the previous parts at that
+// moment fails.
+//
+// open() must be called first. After an error, every call returns the
+// same error; storage_error() tells which storage call failed, if any.
+class MultipartWriteStream {
+public:
+    MultipartWriteStream(
+        const std::string & bucket_id,
+        const std::string & file_name,
+        const std::string & properties,
+        uint64_t part_size,
+        size_t max_in_flight
+    ) : bucket_id(bucket_id), file_name(file_name), properties(properties),
+        part_size(part_size), max_in_flight(std::max<size_t>(max_in_flight, 1)) {
+        uint64_t now = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count();
+        char id[16];
+        std::to_chars_result result = std::to_chars(id, id + sizeof(id), now, 16);
+        upload_id.assign(id, result.ptr);
+    }
+
+    MultipartWriteStream(const MultipartWriteStream &) = delete;
+    MultipartWriteStream & operator=(const MultipartWriteStream &) = delete;
+
+    // Opens the upload (the first part, or the single object)
+    edjx::error::StorageError open() {
+        read_previous_parts();
+        if (part_size == 0) {
+            storage_err = edjx::storage::put_streaming(final_pending, current, bucket_id, file_name, properties);
+        } else {
+            storage_err = open_part();
+        }
+        if (storage_err != edjx::error::StorageError::Success) {
+            err = edjx::error::StreamError::WriteFailed;
+        } else {
+            part_open = true;
+        }
+        return storage_err;
+    }
+
+    edjx::error::StreamError write_chunk(const std::vector<uint8_t> & chunk) {
+        if (err != edjx::error::StreamError::Success) {
+            return err;
+        }
+        total_size += chunk.size();
+        if (part_size == 0) {
+            return check(current.write_chunk(chunk));
+        }
+
+        size_t written = 0;
+        while (written < chunk.size()) {
+            if (part_bytes == part_size && finish_part() != edjx::error::StreamError::Success) {
+                return err;
+            }
+            size_t size = static_cast<size_t>(std::min<uint64_t>(chunk.size() - written, part_size - part_bytes));
+            part_crc.update(chunk.data() + written, size);
+            part_bytes += size;
+            if (size == chunk.size()) {
+                check(current.write_chunk(chunk));
+            } else {
+                piece.assign(chunk.begin() + written, chunk.begin() + written + size);
+                check(current.write_chunk(piece));
+            }
+            if (err != edjx::error::StreamError::Success) {
+                return err;
+            }
+            written += size;
+        }
+        return err;
+    }
+
+    // Closes the last part, waits for every part upload, and uploads the
+    // manifest
+    edjx::error::StreamError close() {
+        if (err != edjx::error::StreamError::Success) {
+            return err;
+        }
+        if (part_size == 0) {
+            part_open = false;
+            return check(current.close(), edjx::error::StreamError::StreamClosed);
+        }
+
+        // The last part is empty only if nothing was uploaded; an empty
+        // upload has a manifest without parts
+        if (part_bytes > 0) {
+            close_part();
+        } else {
+            part_open = false;
+            current.abort();
+            manifest.parts.pop_back();
+        }
+        while (err == edjx::error::StreamError::Success && !in_flight.empty()) {
+            wait_oldest();
+        }
+        if (err != edjx::error::StreamError::Success) {
+            remove_uploaded_parts();
+            return err;
+        }
+
+        manifest.size = total_size;
+        std::string text = format(manifest);
+        if (text.size() > MAX_MANIFEST_SIZE) {
+            remove_uploaded_parts();
+            return check(edjx::error::StreamError::WriteFailed);
+        }
+        std::string manifest_properties = properties.empty()
+            ? std::string(MANIFEST_PROPERTY) + "=1"
+            : properties + "," + MANIFEST_PROPERTY + "=1";
+        storage_err = edjx::storage::put_streaming(
+            final_pending, current, bucket_id, file_name, manifest_properties);
+        if (storage_err != edjx::error::StorageError::Success) {
+            remove_uploaded_parts();
+            return check(edjx::error::StreamError::WriteFailed);
+        }
+        if (check(current.write_chunk(text)) != edjx::error::StreamError::Success) {
+            current.abort();
+            remove_uploaded_parts();
+            return err;
+        }
+        edjx::error::StreamError close_err = check(current.close(), edjx::error::StreamError::StreamClosed);
+        if (close_err != edjx::error::StreamError::Success) {
+            remove_uploaded_parts();
+        }
+        return close_err;
+    }
+
+    // Aborts the open part (or object) and removes the parts that were
+    // closed already, once their uploads are done
+    edjx::error::StreamError abort() {
+        edjx::error::StreamError abort_err = edjx::error::StreamError::Success;
+        if (part_open) {
+            abort_err = current.abort();
+            part_open = false;
+            if (part_size != 0) {
+                manifest.parts.pop_back();
+            }
+        }
+        remove_uploaded_parts();
+        err = edjx::error::StreamError::StreamClosed;
+        return abort_err;
+    }
+
+    // Response of the storage to the upload of the manifest (or of the
+    // single object), after close()
+    //
+    // When the upload is confirmed, the parts of the previous manifest are
+    // removed; when it failed, the parts of this upload are.
+    edjx::error::StorageError get_storage_response(edjx::storage::StorageResponse & result) {
+        edjx::error::StorageError response_err = final_pending.get_storage_response(result);
+        if (response_err == edjx::error::StorageError::Success) {
+            for (const std::string & name : previous_parts) {
+                if (remove_object(name)) {
+                    removed_count++;
+                }
+            }
+            previous_parts.clear();
+        } else {
+            remove_uploaded_parts();
+        }
+        return response_err;
+    }
+
+    // Number of parts of the previous manifest removed by
+    // get_storage_response()
+    size_t removed_parts() const {
+        return removed_count;
+    }
+
+    edjx::error::StorageError storage_error() const {
+        return storage_err;
+    }
+
+    // Parts uploaded so far (all of them after close())
+    const std::vector<Part> & parts() const {
+        return manifest.parts;
+    }
+
+    bool multipart() const {
+        return part_size != 0;
+    }
+
+private:
+    struct PendingPart {
+        size_t index;
+        edjx::storage::StorageResponsePending pending;
+    };
+
+    edjx::error::StorageError open_part() {
+        Part part;
+        part.name = file_name + ".parts/" + upload_id + "/" + std::to_string(manifest.parts.size());
+        edjx::error::StorageError open_err = edjx::storage::put_streaming(
+            next_pending, current, bucket_id, part.name, "");
+        if (open_err == edjx::error::StorageError::Success) {
+            manifest.parts.push_back(std::move(part));
+            part_bytes = 0;
+            part_crc = digest::Crc32c();
+        }
+        return open_err;
+    }
+
+    // Closes the current part and records it as pending
+    void close_part() {
+        part_open = false;
+        Part & part = manifest.parts.back();
+        part.size = part_bytes;
+        part.crc32c = part_crc.value();
+        if (check(current.close()) != edjx::error::StreamError::Success) {
+            return;
+        }
+        in_flight.push_back(PendingPart{manifest.parts.size() - 1, std::move(next_pending)});
+    }
+
+    // Closes the current part and opens the next one, first waiting for the
+    // oldest pending part if `max_in_flight` are pending
+    edjx::error::StreamError finish_part() {
+        close_part();
+        while (err == edjx::error::StreamError::Success && in_flight.size() >= max_in_flight) {
+            wait_oldest();
+        }
+        if (err != edjx::error::StreamError::Success) {
+            return err;
+        }
+        storage_err = open_part();
+        if (storage_err != edjx::error::StorageError::Success) {
+            return check(edjx::error::StreamError::WriteFailed);
+        }
+        part_open = true;
+        return err;
+    }
+
+    // Collects the parts of the current content of the file if it is a
+    // manifest (a file that is not one is read up to its first chunk)
+    void read_previous_parts() {
+        edjx::storage::StorageResponse response;
+        if (edjx::storage::get(response, bucket_id, file_name) != edjx::error::StorageError::Success) {
+            return;
+        }
+        edjx::stream::ReadStream stream = response.get_read_stream();
+        std::string text;
+        std::vector<uint8_t> chunk;
+        edjx::error::StreamError read_err;
+        while ((read_err = stream.read_chunk(chunk)) == edjx::error::StreamError::Success) {
+            text.append(chunk.begin(), chunk.end());
+            if (text.size() > MAX_MANIFEST_SIZE || !looks_like_manifest(text)) {
+                break;
+            }
+        }
+        stream.close();
+
+        Manifest previous;
+        if (read_err != edjx::error::StreamError::EndOfStream || !parse(text, file_name, previous)) {
+            return;
+        }
+        for (Part & part : previous.parts) {
+            previous_parts.push_back(std::move(part.name));
+        }
+    }
+
+    // Removes the parts stored by this upload, after waiting for the pending
+    // ones; no part may be open
+    void remove_uploaded_parts() {
+        while (!in_flight.empty()) {
+            edjx::storage::StorageResponse response;
+            in_flight.front().pending.get_storage_response(response);
+            in_flight.pop_front();
+        }
+        for (const Part & part : manifest.parts) {
+            remove_object(part.name);
+        }
+        manifest.parts.clear();
+    }
+
+    // Removes an object; a missing object is not an error
+    bool remove_object(const std::string & name) {
+        edjx::storage::StorageResponse response;
+        return edjx::storage::remove(response, bucket_id, name) == edjx::error::StorageError::Success;
+    }
+
+    void wait_oldest() {
+        edjx::storage::StorageResponse response;
+        edjx::error::StorageError wait_err = in_flight.front().pending.get_storage_response(response);
+        in_flight.pop_front();
+        if (wait_err != edjx::error::StorageError::Success) {
+            storage_err = wait_err;
+            check(edjx::error::StreamError::WriteFailed);
+        }
+    }
+
+    // Keeps the first error; later calls fail with `then` even if `result`
+    // is a success (e.g., StreamClosed after close())
+    edjx::error::StreamError check(
+        edjx::error::StreamError result,
+        edjx::error::StreamError then = edjx::error::StreamError::Success
+    ) {
+        err = result != edjx::error::StreamError::Success ? result : then;
+        return result;
+    }
+
+    std::string bucket_id;
+    std::string file_name;
+    std::string properties;
+    uint64_t part_size;
+    size_t max_in_flight;
+    std::string upload_id;
+
+    edjx::stream::WriteStream current;
+    bool part_open = false;
+    uint64_t part_bytes = 0;
+    digest::Crc32c part_crc;
+    std::vector<uint8_t> piece;
+    edjx::storage::StorageResponsePending next_pending;
+    std::deque<PendingPart> in_flight;
+    edjx::storage::StorageResponsePending final_pending;
+
+    Manifest manifest;
+    uint64_t total_size = 0;
+    std::vector<std::string> previous_parts;
+    size_t removed_count = 0;
+    edjx::error::StreamError err = edjx::error::StreamError::Success;
+    edjx::error::StorageError storage_err = edjx::error::StorageError::Success;
+};
+
+} // namespace multipart
+} // namespace edjsamples
+
+#endif // EDJSAMPLES_MULTIPART_HPP
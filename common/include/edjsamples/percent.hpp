@@ -0,0 +1,184 @@
+#ifndef EDJSAMPLES_PERCENT_HPP
+#define EDJSAMPLES_PERCENT_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <optional>
+
+#ifdef __wasm_simd128__
+#include <wasm_simd128.h>
+#endif
+
+namespace edjsamples {
+namespace percent {
+
+namespace detail {
+
+inline int hex_value(char c) {
+    if (c >= '0' && c <= '9') {
+        return c - '0';
+    }
+    if (c >= 'a' && c <= 'f') {
+        return c - 'a' + 10;
+    }
+    if (c >= 'A' && c <= 'F') {
+        return c - 'A' + 10;
+    }
+    return -1;
+}
+
+// Decodes the escape at in[i] (in[i] == '%'), returns false if it is malformed
+inline bool decode_escape(const char * in, size_t size, size_t i, char & decoded) {
+    if (i + 2 >= size) {
+        return false;
+    }
+    int high = hex_value(in[i + 1]);
+    int low = hex_value(in[i + 2]);
+    if (high < 0 || low < 0) {
+        return false;
+    }
+    decoded = static_cast<char>((high << 4) | low);
+    return true;
+}
+
+} // namespace detail
+
+// Decodes %XX escapes of `in` into `out` and returns the decoded size,
+// or std::nullopt if an escape is malformed ('%' not followed by two hex
+// digits). With `plus_as_space`, '+' decodes to ' '
+// (application/x-www-form-urlencoded, query strings).
+//
+// `out` must have room for `size` bytes. It may be equal to `in`
+// (the decoded data is never longer than the input), so the decoding can be
+// done in place.
+//
+// When the module is built with -msimd128, runs of 16 bytes without
+// '%' are copied (and their '+' replaced) with SIMD instructions.
+inline std::optional<size_t> decode(const char * in, size_t size, char * out, bool plus_as_space = true) {
+    size_t i = 0;
+    size_t o = 0;
+
+#ifdef __wasm_simd128__
+    const v128_t percent_v = wasm_i8x16_splat('%');
+    const v128_t plus_v = wasm_i8x16_splat('+');
+    const v128_t space_v = wasm_i8x16_splat(' ');
+    while (i + 16 <= size) {
+        v128_t chunk = wasm_v128_load(in + i);
+        v128_t plus_mask = plus_as_space ? wasm_i8x16_eq(chunk, plus_v) : wasm_i8x16_splat(0);
+        chunk = wasm_v128_bitselect(space_v, chunk, plus_mask);
+        uint32_t escapes = wasm_i8x16_bitmask(wasm_i8x16_eq(chunk, percent_v));
+        if (escapes == 0) {
+            // out + o <= in + i, so the store does not overwrite unread input
+            wasm_v128_store(out + o, chunk);
+            i += 16;
+            o += 16;
+            continue;
+        }
+        // Copy only the bytes before the first escape (storing the whole
+        // chunk could overwrite the escape when decoding in place),
+        // then decode the escape
+        size_t plain = __builtin_ctz(escapes);
+        char chunk_bytes[16];
+        wasm_v128_store(chunk_bytes, chunk);
+        memcpy(out + o, chunk_bytes, plain);
+        i += plain;
+        o += plain;
+        char decoded;
+        if (!detail::decode_escape(in, size, i, decoded)) {
+            return std::nullopt;
+        }
+        out[o++] = decoded;
+        i += 3;
+    }
+#endif
+
+    while (i < size) {
+        char c = in[i];
+        if (c == '%') {
+            if (!detail::decode_escape(in, size, i, c)) {
+                return std::nullopt;
+            }
+            i += 3;
+        } else {
+            if (c == '+' && plus_as_space) {
+                c = ' ';
+            }
+            i++;
+        }
+        out[o++] = c;
+    }
+
+    return o;
+}
+
+// Decodes `str` in place, returns false if an escape is malformed
+// (`str` is left unspecified then)
+inline bool decode_in_place(std::string & str, bool plus_as_space = true) {
+    std::optional<size_t> size = decode(str.data(), str.size(), str.data(), plus_as_space);
+    if (!size.has_value()) {
+        return false;
+    }
+    str.resize(size.value());
+    return true;
+}
+
+// Decoded copy of `str`, or std::nullopt if an escape is malformed
+inline std::optional<std::string> decode(std::string_view str, bool plus_as_space = true) {
+    std::string result(str);
+    if (!decode_in_place(result, plus_as_space)) {
+        return std::nullopt;
+    }
+    return result;
+}
+
+// Incremental check of the %XX escapes of data that is received in chunks
+// (e.g., from ReadStream::read_chunk()); an escape may be split between chunks
+class Validator {
+public:
+    // Checks the next chunk, returns false at the first malformed escape
+    bool feed(const uint8_t * data, size_t size) {
+        if (failed) {
+            return false;
+        }
+        const char * chars = reinterpret_cast<const char *>(data);
+        for (size_t i = 0; i < size; i++) {
+            if (pending_digits == 0) {
+                const void * percent = memchr(chars + i, '%', size - i);
+                if (percent == nullptr) {
+                    break;
+                }
+                i = static_cast<const char *>(percent) - chars;
+                pending_digits = 2;
+            } else if (detail::hex_value(chars[i]) >= 0) {
+                pending_digits--;
+            } else {
+                failed = true;
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool feed(const std::vector<uint8_t> & chunk) {
+        return feed(chunk.data(), chunk.size());
+    }
+
+    // Checks the end of the data, returns false if it ends inside an escape
+    bool finish() {
+        failed = failed || pending_digits != 0;
+        return !failed;
+    }
+
+private:
+    unsigned pending_digits = 0; // Hex digits of the current escape that were not received yet
+    bool failed = false;
+};
+
+} // namespace percent
+} // namespace edjsamples
+
+#endif // EDJSAMPLES_PERCENT_HPP
@@ -0,0 +1,107 @@
+#ifndef EDJSAMPLES_PROGRESS_HPP
+#define EDJSAMPLES_PROGRESS_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <string_view>
+
+namespace edjsamples {
+namespace progress {
+
+// Rate-limited progress of a transfer
+//
+// add() is called for every transferred chunk and returns true when an
+// update is due: when at least `byte_interval` bytes were transferred or
+// `time_interval` elapsed since the last update. Updates are formatted
+// into a caller-provided stack buffer, without heap allocations.
+class ProgressReporter {
+public:
+    using clock = std::chrono::steady_clock;
+
+    // Size of the buffer passed to format()
+    static const size_t MAX_UPDATE_SIZE = 96;
+
+    ProgressReporter(uint64_t byte_interval, std::chrono::milliseconds time_interval)
+        : byte_interval(byte_interval), time_interval(time_interval),
+          start(clock::now()), last_update(start) {}
+
+    // Records a transferred chunk, returns true if an update is due
+    bool add(size_t chunk_size) {
+        chunk_count++;
+        byte_count += chunk_size;
+        clock::time_point now = clock::now();
+        if (byte_count - last_update_bytes >= byte_interval || now - last_update >= time_interval) {
+            last_update = now;
+            last_update_bytes = byte_count;
+            return true;
+        }
+        return false;
+    }
+
+    // True if bytes were transferred after the last update
+    bool pending() const {
+        return byte_count != last_update_bytes;
+    }
+
+    // Marks the current progress as reported (e.g., before a final update)
+    void mark_reported() {
+        last_update = clock::now();
+        last_update_bytes = byte_count;
+    }
+
+    uint64_t chunks() const {
+        return chunk_count;
+    }
+
+    uint64_t bytes() const {
+        return byte_count;
+    }
+
+    // Average throughput since the start in bytes per second
+    uint64_t bytes_per_second() const {
+        uint64_t elapsed_us = std::chrono::duration_cast<std::chrono::microseconds>(clock::now() - start).count();
+        if (elapsed_us == 0) {
+            return 0;
+        }
+        return static_cast<uint64_t>(static_cast<double>(byte_count) * 1000000 / elapsed_us);
+    }
+
+    // Formats "Sent <chunks> chunks, <bytes> bytes (<throughput> KiB/s)\r\n"
+    // into `buffer` and returns the formatted part
+    std::string_view format(char (& buffer)[MAX_UPDATE_SIZE]) const {
+        char * out = buffer;
+        char * end = buffer + MAX_UPDATE_SIZE;
+        out = append(out, end, "Sent ");
+        out = std::to_chars(out, end, chunk_count).ptr;
+        out = append(out, end, " chunks, ");
+        out = std::to_chars(out, end, byte_count).ptr;
+        out = append(out, end, " bytes (");
+        out = std::to_chars(out, end, bytes_per_second() / 1024).ptr;
+        out = append(out, end, " KiB/s)\r\n");
+        return std::string_view(buffer, out - buffer);
+    }
+
+private:
+    // The buffer is large enough for the longest update
+    static char * append(char * out, char * end, std::string_view text) {
+        size_t n = std::min(text.size(), static_cast<size_t>(end - out));
+        text.copy(out, n);
+        return out + n;
+    }
+
+    uint64_t byte_interval;
+    clock::duration time_interval;
+    clock::time_point start;
+    clock::time_point last_update;
+    uint64_t chunk_count = 0;
+    uint64_t byte_count = 0;
+    uint64_t last_update_bytes = 0;
+};
+
+} // namespace progress
+} // namespace edjsamples
+
+#endif // EDJSAMPLES_PROGRESS_HPP
@@ -0,0 +1,120 @@
+#ifndef EDJSAMPLES_QUERY_HPP
+#define EDJSAMPLES_QUERY_HPP
+
+#include <cstddef>
+#include <array>
+#include <vector>
+#include <string_view>
+#include <optional>
+
+#include <edjsamples/percent.hpp>
+
+namespace edjsamples {
+namespace query {
+
+struct Parameter {
+    std::string_view name;
+    std::string_view value;
+};
+
+// Query parameters of a URI, parsed in a single pass
+// e.g., https://example.com/path/to/page?name=ferret&color=purple
+//
+// Names and values are slices of the parsed URI (use get_decoded() for
+// percent-decoded values), so the URI must outlive the QueryParams object. The first INLINE_CAPACITY
+// parameters are stored inline; only longer queries allocate.
+class QueryParams {
+public:
+    static const size_t INLINE_CAPACITY = 16;
+
+    explicit QueryParams(std::string_view uri) {
+        size_t query_start = uri.find('?');
+        if (query_start == std::string_view::npos) {
+            return;
+        }
+        std::string_view query = uri.substr(query_start + 1);
+        query = query.substr(0, query.find('#'));
+
+        while (!query.empty()) {
+            size_t end = query.find('&');
+            std::string_view parameter = query.substr(0, end);
+            if (!parameter.empty()) {
+                size_t separator = parameter.find('=');
+                if (separator == std::string_view::npos) {
+                    add({parameter, std::string_view()});
+                } else {
+                    add({parameter.substr(0, separator), parameter.substr(separator + 1)});
+                }
+            }
+            if (end == std::string_view::npos) {
+                break;
+            }
+            query.remove_prefix(end + 1);
+        }
+    }
+
+    // The parameters would point into a destroyed temporary
+    explicit QueryParams(std::string && uri) = delete;
+
+    size_t size() const {
+        return count;
+    }
+
+    const Parameter & operator[](size_t index) const {
+        return index < INLINE_CAPACITY ? inline_parameters[index] : overflow[index - INLINE_CAPACITY];
+    }
+
+    // Value of the `occurrence`-th parameter called `name` (for repeated keys)
+    std::optional<std::string_view> get(std::string_view name, size_t occurrence = 0) const {
+        for (size_t i = 0; i < count; i++) {
+            const Parameter & parameter = (*this)[i];
+            if (parameter.name == name) {
+                if (occurrence == 0) {
+                    return parameter.value;
+                }
+                occurrence--;
+            }
+        }
+        return {};
+    }
+
+    // Percent-decoded value ('+' decodes to ' ') of the `occurrence`-th
+    // parameter called `name`. A value with a malformed escape is treated
+    // as missing.
+    std::optional<std::string> get_decoded(std::string_view name, size_t occurrence = 0) const {
+        std::optional<std::string_view> value = get(name, occurrence);
+        if (!value.has_value()) {
+            return {};
+        }
+        return edjsamples::percent::decode(value.value());
+    }
+
+    size_t count_of(std::string_view name) const {
+        size_t n = 0;
+        for (size_t i = 0; i < count; i++) {
+            if ((*this)[i].name == name) {
+                n++;
+            }
+        }
+        return n;
+    }
+
+private:
+    void add(const Parameter & parameter) {
+        if (count < INLINE_CAPACITY) {
+            inline_parameters[count] = parameter;
+        } else {
+            overflow.push_back(parameter);
+        }
+        count++;
+    }
+
+    std::array<Parameter, INLINE_CAPACITY> inline_parameters;
+    std::vector<Parameter> overflow;
+    size_t count = 0;
+};
+
+} // namespace query
+} // namespace edjsamples
+
+#endif // EDJSAMPLES_QUERY_HPP
@@ -0,0 +1,111 @@
+#ifndef EDJSAMPLES_RANGE_HPP
+#define EDJSAMPLES_RANGE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <charconv>
+#include <string>
+#include <string_view>
+
+#include <edjsamples/ascii.hpp>
+
+namespace edjsamples {
+namespace range {
+
+// Inclusive range of bytes of a representation, as in "Content-Range: bytes first-last/size"
+struct ByteRange {
+    uint64_t first = 0;
+    uint64_t last = 0;
+
+    uint64_t length() const {
+        return last - first + 1;
+    }
+};
+
+enum class RangeStatus {
+    // No Range header, or one that is ignored (malformed, not in bytes, or
+    // with several ranges); the whole representation is sent with 200
+    Ignored,
+    // Send `range` with 206 Partial Content
+    Satisfiable,
+    // No byte of the range is in the representation; answer with 416
+    Unsatisfiable,
+};
+
+namespace detail {
+
+inline bool parse_position(std::string_view text, uint64_t & position) {
+    if (text.empty()) {
+        return false;
+    }
+    std::from_chars_result result = std::from_chars(text.data(), text.data() + text.size(), position);
+    return result.ec == std::errc() && result.ptr == text.data() + text.size();
+}
+
+} // namespace detail
+
+// Parses the value of a Range header (RFC 9110, section 14.2) for a
+// representation of `size` bytes
+//
+// Supports a single range of the forms "bytes=first-last", "bytes=first-"
+// and "bytes=-suffix_length". A last position past the end is limited to
+// the last byte.
+inline RangeStatus parse(std::string_view header, uint64_t size, ByteRange & range) {
+    static const std::string_view UNIT = "bytes=";
+
+    header = ascii::trim(header);
+    if (header.size() < UNIT.size() || !ascii::equal_nocase(header.substr(0, UNIT.size()), UNIT)) {
+        return RangeStatus::Ignored;
+    }
+    std::string_view spec = ascii::trim(header.substr(UNIT.size()));
+    size_t dash = spec.find('-');
+    if (dash == std::string_view::npos || spec.find(',') != std::string_view::npos) {
+        return RangeStatus::Ignored;
+    }
+    std::string_view first_text = spec.substr(0, dash);
+    std::string_view last_text = spec.substr(dash + 1);
+
+    if (first_text.empty()) {
+        // Suffix range: the last `suffix_length` bytes
+        uint64_t suffix_length;
+        if (!detail::parse_position(last_text, suffix_length)) {
+            return RangeStatus::Ignored;
+        }
+        if (suffix_length == 0 || size == 0) {
+            return RangeStatus::Unsatisfiable;
+        }
+        range.first = suffix_length >= size ? 0 : size - suffix_length;
+        range.last = size - 1;
+        return RangeStatus::Satisfiable;
+    }
+
+    uint64_t first;
+    if (!detail::parse_position(first_text, first)) {
+        return RangeStatus::Ignored;
+    }
+    uint64_t last = UINT64_MAX;
+    if (!last_text.empty() && (!detail::parse_position(last_text, last) || last < first)) {
+        return RangeStatus::Ignored;
+    }
+    if (first >= size) {
+        return RangeStatus::Unsatisfiable;
+    }
+    range.first = first;
+    range.last = last >= size ? size - 1 : last;
+    return RangeStatus::Satisfiable;
+}
+
+// Value of the Content-Range header of a 206 response
+inline std::string content_range(const ByteRange & range, uint64_t size) {
+    return "bytes " + std::to_string(range.first) + "-" + std::to_string(range.last) + "/" + std::to_string(size);
+}
+
+// Value of the Content-Range header of a 416 response
+inline std::string unsatisfied_content_range(uint64_t size) {
+    return "bytes */" + std::to_string(size);
+}
+
+} // namespace range
+} // namespace edjsamples
+
+#endif // EDJSAMPLES_RANGE_HPP
@@ -0,0 +1,336 @@
+#ifndef EDJSAMPLES_STREAM_HPP
+#define EDJSAMPLES_STREAM_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <chrono>
+#include <algorithm>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <edjx/error.hpp>
+#include <edjx/stream.hpp>
+
+namespace edjsamples {
+namespace stream {
+
+// Write stream that coalesces small writes
+//
+// Every WriteStream::write_chunk() is a host call. BufferedWriteStream
+// collects the written data and passes it to write_chunk() in chunks of at
+// least `flush_threshold` bytes (except the last one). A chunk that is at
+// least `flush_threshold` bytes long is passed through without being copied
+// if nothing is buffered.
+//
+// flush() writes the buffered data immediately. close() flushes and closes
+// the stream; if the flush fails, the stream is aborted instead. abort()
+// discards the buffered data. After an error, the same error is returned by
+// every later call except abort().
+class BufferedWriteStream {
+public:
+    static const size_t DEFAULT_FLUSH_THRESHOLD = 16 * 1024;
+
+    explicit BufferedWriteStream(
+        edjx::stream::WriteStream & stream,
+        size_t flush_threshold = DEFAULT_FLUSH_THRESHOLD
+    ) : stream(stream), flush_threshold(flush_threshold) {
+        buffer.reserve(flush_threshold);
+    }
+
+    BufferedWriteStream(const BufferedWriteStream &) = delete;
+    BufferedWriteStream & operator=(const BufferedWriteStream &) = delete;
+
+    edjx::error::StreamError write(const uint8_t * data, size_t size) {
+        if (err != edjx::error::StreamError::Success) {
+            return err;
+        }
+        buffer.insert(buffer.end(), data, data + size);
+        if (buffer.size() >= flush_threshold) {
+            return flush();
+        }
+        return edjx::error::StreamError::Success;
+    }
+
+    edjx::error::StreamError write(std::string_view text) {
+        return write(reinterpret_cast<const uint8_t *>(text.data()), text.size());
+    }
+
+    edjx::error::StreamError write_chunk(const std::vector<uint8_t> & data) {
+        if (err == edjx::error::StreamError::Success && buffer.empty() && data.size() >= flush_threshold) {
+            return check(stream.write_chunk(data));
+        }
+        return write(data.data(), data.size());
+    }
+
+    edjx::error::StreamError write_chunk(const std::string & text) {
+        if (err == edjx::error::StreamError::Success && buffer.empty() && text.size() >= flush_threshold) {
+            return check(stream.write_chunk(text));
+        }
+        return write(text);
+    }
+
+    edjx::error::StreamError flush() {
+        if (err != edjx::error::StreamError::Success || buffer.empty()) {
+            return err;
+        }
+        check(stream.write_chunk(buffer));
+        buffer.clear();
+        return err;
+    }
+
+    edjx::error::StreamError close() {
+        if (flush() != edjx::error::StreamError::Success) {
+            stream.abort();
+            return err;
+        }
+        return check(stream.close(), edjx::error::StreamError::StreamClosed);
+    }
+
+    edjx::error::StreamError abort() {
+        buffer.clear();
+        edjx::error::StreamError abort_err = stream.abort();
+        err = edjx::error::StreamError::StreamClosed;
+        return abort_err;
+    }
+
+    // Number of bytes written but not flushed yet
+    size_t buffered() const {
+        return buffer.size();
+    }
+
+private:
+    // Keeps the first error; later calls fail with `then` even if `result`
+    // is a success (e.g., StreamClosed after close())
+    edjx::error::StreamError check(
+        edjx::error::StreamError result,
+        edjx::error::StreamError then = edjx::error::StreamError::Success
+    ) {
+        err = result != edjx::error::StreamError::Success ? result : then;
+        return result;
+    }
+
+    edjx::stream::WriteStream & stream;
+    size_t flush_threshold;
+    std::vector<uint8_t> buffer;
+    edjx::error::StreamError err = edjx::error::StreamError::Success;
+};
+
+// View of contiguous bytes (e.g., a part of a chunk or of a string)
+struct ByteSpan {
+    const uint8_t * data = nullptr;
+    size_t size = 0;
+
+    ByteSpan() = default;
+    ByteSpan(const uint8_t * data, size_t size) : data(data), size(size) {}
+    ByteSpan(std::string_view text)
+        : data(reinterpret_cast<const uint8_t *>(text.data())), size(text.size()) {}
+};
+
+// Fixed set of chunk buffers that are allocated once and reused by the
+// streaming loops, so that reading and writing chunks in a steady state
+// makes no heap allocations
+//
+// acquire() moves an empty buffer with `chunk_capacity` bytes of capacity
+// out of the pool, release() moves it back. If every buffer is in use,
+// acquire() allocates a new one (counted by allocations()); buffers
+// released to a full pool are freed.
+class ChunkPool {
+public:
+    ChunkPool(size_t buffer_count, size_t chunk_capacity)
+        : chunk_capacity(chunk_capacity), buffer_count(buffer_count) {
+        free_buffers.reserve(buffer_count);
+        for (size_t i = 0; i < buffer_count; i++) {
+            free_buffers.push_back(allocate());
+        }
+    }
+
+    ChunkPool(const ChunkPool &) = delete;
+    ChunkPool & operator=(const ChunkPool &) = delete;
+
+    std::vector<uint8_t> acquire() {
+        if (free_buffers.empty()) {
+            return allocate();
+        }
+        std::vector<uint8_t> buffer = std::move(free_buffers.back());
+        free_buffers.pop_back();
+        return buffer;
+    }
+
+    void release(std::vector<uint8_t> && buffer) {
+        if (free_buffers.size() < buffer_count) {
+            buffer.clear();
+            free_buffers.push_back(std::move(buffer));
+        }
+    }
+
+    size_t capacity() const {
+        return chunk_capacity;
+    }
+
+    // Buffers allocated so far, including the initial `buffer_count`
+    size_t allocations() const {
+        return allocated;
+    }
+
+private:
+    std::vector<uint8_t> allocate() {
+        std::vector<uint8_t> buffer;
+        buffer.reserve(chunk_capacity);
+        allocated++;
+        return buffer;
+    }
+
+    size_t chunk_capacity;
+    size_t buffer_count;
+    size_t allocated = 0;
+    std::vector<std::vector<uint8_t>> free_buffers;
+};
+
+// Reads the chunks of a ReadStream into a buffer of a ChunkPool
+//
+// The read buffer is passed to ReadStream::read_chunk() every time, so
+// its capacity is reused as long as the SDK resizes or assigns the buffer
+// instead of replacing it; reallocations() counts the chunks for which the
+// storage of the buffer changed.
+class ChunkReader {
+public:
+    ChunkReader(edjx::stream::ReadStream & stream, ChunkPool & pool)
+        : stream(stream), pool(pool), buffer(pool.acquire()) {}
+
+    ~ChunkReader() {
+        pool.release(std::move(buffer));
+    }
+
+    ChunkReader(const ChunkReader &) = delete;
+    ChunkReader & operator=(const ChunkReader &) = delete;
+
+    // Reads the next chunk; `chunk` is valid until the next read()
+    edjx::error::StreamError read(ByteSpan & chunk) {
+        const uint8_t * storage = buffer.data();
+        size_t capacity = buffer.capacity();
+        edjx::error::StreamError err = stream.read_chunk(buffer);
+        if (buffer.data() != storage || buffer.capacity() != capacity) {
+            realloc_count++;
+        }
+        chunk = ByteSpan(buffer.data(), buffer.size());
+        return err;
+    }
+
+    // The last chunk that was read (e.g., for WriteStream::write_chunk())
+    const std::vector<uint8_t> & last_chunk() const {
+        return buffer;
+    }
+
+    uint64_t reallocations() const {
+        return realloc_count;
+    }
+
+private:
+    edjx::stream::ReadStream & stream;
+    ChunkPool & pool;
+    std::vector<uint8_t> buffer;
+    uint64_t realloc_count = 0;
+};
+
+// Writes spans of bytes to a WriteStream through a buffer of a ChunkPool
+//
+// WriteStream::write_chunk() takes a std::vector or a std::string;
+// write(ByteSpan) copies the span into the pooled buffer instead of
+// constructing a new one for every chunk. Spans longer than the capacity of
+// the pool are written in several chunks.
+class ChunkWriter {
+public:
+    ChunkWriter(edjx::stream::WriteStream & stream, ChunkPool & pool)
+        : stream(stream), pool(pool), buffer(pool.acquire()) {}
+
+    ~ChunkWriter() {
+        pool.release(std::move(buffer));
+    }
+
+    ChunkWriter(const ChunkWriter &) = delete;
+    ChunkWriter & operator=(const ChunkWriter &) = delete;
+
+    edjx::error::StreamError write(ByteSpan chunk) {
+        size_t piece_size = std::max<size_t>(pool.capacity(), 1);
+        while (chunk.size > 0) {
+            size_t n = std::min(chunk.size, piece_size);
+            buffer.assign(chunk.data, chunk.data + n);
+            edjx::error::StreamError err = stream.write_chunk(buffer);
+            if (err != edjx::error::StreamError::Success) {
+                return err;
+            }
+            chunk.data += n;
+            chunk.size -= n;
+        }
+        return edjx::error::StreamError::Success;
+    }
+
+    edjx::error::StreamError close() {
+        return stream.close();
+    }
+
+    edjx::error::StreamError abort() {
+        return stream.abort();
+    }
+
+private:
+    edjx::stream::WriteStream & stream;
+    ChunkPool & pool;
+    std::vector<uint8_t> buffer;
+};
+
+// Statistics of copy()
+struct CopyStats {
+    uint64_t chunks = 0;
+    uint64_t bytes = 0;
+    std::chrono::nanoseconds read_stall{0};  // Time spent in read_chunk()
+    std::chrono::nanoseconds write_stall{0}; // Time spent in write_chunk()
+};
+
+// Copies the remaining chunks of `read_stream` into `write_stream` and adds
+// them to `stats`. Returns StreamError::Success at the end of the read
+// stream, or the first read or write error.
+//
+// Unlike ReadStream::pipe_to(), neither stream is closed, so more data
+// (e.g., a summary) can be written after the copied chunks. The read and
+// write calls of the SDK block until they are done and the function runs
+// on a single thread, so reading the next chunk cannot overlap with writing
+// the previous one; the stall times show which side the copy waits for.
+// The chunks are read into a buffer of `pool`.
+inline edjx::error::StreamError copy(
+    edjx::stream::ReadStream & read_stream,
+    edjx::stream::WriteStream & write_stream,
+    CopyStats & stats,
+    ChunkPool & pool
+) {
+    using clock = std::chrono::steady_clock;
+
+    ChunkReader reader(read_stream, pool);
+    ByteSpan chunk;
+    while (true) {
+        clock::time_point read_start = clock::now();
+        edjx::error::StreamError read_err = reader.read(chunk);
+        clock::time_point read_end = clock::now();
+        stats.read_stall += read_end - read_start;
+        if (read_err == edjx::error::StreamError::EndOfStream) {
+            return edjx::error::StreamError::Success;
+        }
+        if (read_err != edjx::error::StreamError::Success) {
+            return read_err;
+        }
+
+        edjx::error::StreamError write_err = write_stream.write_chunk(reader.last_chunk());
+        stats.write_stall += clock::now() - read_end;
+        if (write_err != edjx::error::StreamError::Success) {
+            return write_err;
+        }
+        stats.chunks++;
+        stats.bytes += chunk.size;
+    }
+}
+
+} // namespace stream
+} // namespace edjsamples
+
+#endif // EDJSAMPLES_STREAM_HPP
@@ -1,117 +1,45 @@
 #include <cstdint>
 #include <string>
 #include <vector>
+#include <optional>
 
 #include <edjx/storage.hpp>
+#include <edjx/kv.hpp>
 #include <edjx/logger.hpp>
 #include <edjx/error.hpp>
 #include <edjx/request.hpp>
 #include <edjx/response.hpp>
 #include <edjx/http.hpp>
 
+#include <edjsamples/query.hpp>
+#include <edjsamples/json.hpp>
+#include <edjsamples/kv_cache.hpp>
+
 using edjx::request::HttpRequest;
 using edjx::response::HttpResponse;
 using edjx::error::StorageError;
+using edjx::error::KVError;
 using edjx::storage::StorageResponse;
 using edjx::storage::FileAttributes;
 using edjx::logger::info;
 using edjx::logger::error;
 using edjx::http::HttpStatusCode;
+using edjsamples::query::QueryParams;
+using edjsamples::json::Writer;
+using edjsamples::json::StringSink;
+using edjsamples::json::CountingSink;
 
 static const HttpStatusCode HTTP_STATUS_OK = 200;
 static const HttpStatusCode HTTP_STATUS_BAD_REQUEST = 400;
 
-std::optional<std::string> query_param_by_name(const HttpRequest & req, const std::string & param_name) {
-    std::string uri = req.get_uri().as_string();
-    std::vector<std::pair<std::string, std::string>> query_parsed;
-
-    // e.g., https://example.com/path/to/page?name=ferret&color=purple
-
-    size_t query_start = uri.find('?');
-
-    if (query_start != std::string::npos) {
-        // Query is present
-        std::string name;
-        std::string value;
-        bool parsing_name = true;
-        for (std::string::iterator it = uri.begin() + query_start + 1; it != uri.end(); ++it) {
-            char c = *it;
-            switch (c) {
-                case '?':
-                    break; // Invalid URI
-                case '=':
-                    parsing_name = false;
-                    break;
-                case '&':
-                    query_parsed.push_back(make_pair(name, value));
-                    name.clear();
-                    value.clear();
-                    parsing_name = true;
-                    break;
-                default:
-                    if (parsing_name) {
-                        name += c;
-                    } else {
-                        value += c;
-                    }
-                    break;
-            }
-        }
-        if (!name.empty() || !value.empty()) {
-            query_parsed.push_back(make_pair(name, value));
-        }
-
-        for (const auto & parameter : query_parsed) {
-            if (parameter.first == param_name) {
-                return parameter.second;
-            }
-        }
-    }
-
-    return {};
-}
-
-std::string sanitize_json_string(const std::string & value) {
-    std::string escaped;
-    escaped.reserve(value.length()); // May grow larger
-
-    // JSON specification is at https://www.json.org
-    for (char c : value) {
-        switch (c) {
-            case '\"':
-                escaped += "\\\"";
-                break;
-            case '\\':
-                escaped += "\\\\";
-                break;
-            case '/':
-                // Forward slash may be escaped but it is not required
-                escaped += c;
-                break;
-            case '\b':
-                escaped += "\\b";
-                break;
-            case '\f':
-                escaped += "\\f";
-                break;
-            case '\n':
-                escaped += "\\n";
-                break;
-            case '\r':
-                escaped += "\\r";
-                break;
-            case '\t':
-                escaped += "\\t";
-                break;
-            default:
-                escaped += c;
-                break;
-        }
-    }
-    return escaped;
-}
+// Time to live of the attributes cached in the KV store, in milliseconds.
+// edjstorage-set-attributes removes the cached attributes of a file it
+// updates; other changes (e.g., a new upload, which changes the version)
+// are visible after at most this time.
+static const uint64_t ATTRIBUTES_CACHE_TTL_MS = 60 * 1000;
 
-std::string to_json(const FileAttributes & file_attributes) {
+template <typename Sink>
+void write_json(Sink & sink, const FileAttributes & file_attributes) {
     // ORIGINAL STRUCTURE:
     // pub struct FileAttributes {
     //     pub properties: Option<HashMap<String, String>>,
@@ -121,39 +49,51 @@ std::string to_json(const FileAttributes & file_attributes) {
     // EXAMPLE JSON:
     // {"properties":{"Content-Type":"image/jpeg","Cache-Control":"no-cache"},"defaultVersion":null}
 
-    std::string json = "{\"properties\":";
+    Writer<Sink> json(sink);
+    json.begin_object();
+
+    json.key("properties");
     if (file_attributes.properties_present) {
-        json += "{";
-        bool first_entry = true;
+        json.begin_object();
         for (const auto & property : file_attributes.properties) {
-            if (first_entry) {
-                first_entry = false;
-            } else {
-                json += ",";
-            }
-            json += "\"" + sanitize_json_string(property.first) + "\":\"" + sanitize_json_string(property.second) + "\"";
+            json.key(property.first);
+            json.string(property.second);
         }
-        json += "}";
+        json.end_object();
     } else {
-        json += "null";
+        json.null();
     }
 
-    json += ",\"defaultVersion\":";
+    json.key("defaultVersion");
     if (file_attributes.default_version_present) {
-        json += "\"" + sanitize_json_string(file_attributes.default_version) + "\"";
+        json.string(file_attributes.default_version);
     } else {
-        json += "null";
+        json.null();
     }
-    json += "}";
 
+    json.end_object();
+}
+
+std::string to_json(const FileAttributes & file_attributes) {
+    // Measure the JSON first, so that it is allocated only once
+    CountingSink counter;
+    write_json(counter, file_attributes);
+
+    std::string json;
+    json.reserve(counter.size());
+    StringSink sink(json);
+    write_json(sink, file_attributes);
     return json;
 }
 
 HttpResponse serverless(const HttpRequest & req) {
     info("New Req Framework For Set-Attributes Functionality");
 
+    std::string uri = req.get_uri().as_string();
+    QueryParams query(uri);
+
     // 1. param (required): "file_name" -> name that will be given to the uploaded content
-    std::optional<std::string> file_name = query_param_by_name(req, "file_name");
+    std::optional<std::string> file_name = query.get_decoded("file_name");
     if (!file_name.has_value()) {
         error("No file_name found in query params of request");
         return HttpResponse("No file name found in query params of request")
@@ -161,13 +101,32 @@ HttpResponse serverless(const HttpRequest & req) {
     };
 
     // 2. param (required): "bucket_id" -> in which bucket content will be uploaded
-    std::optional<std::string> bucket_id = query_param_by_name(req, "bucket_id");
+    std::optional<std::string> bucket_id = query.get_decoded("bucket_id");
     if (!bucket_id.has_value()) {
         error("No bucket id found in query params of request");
         return HttpResponse("No bucket id found in query params of request")
             .set_status(HTTP_STATUS_BAD_REQUEST);
     };
 
+    // Serve the attributes from the KV store if they are cached there
+    std::string cache_key = edjsamples::kv_cache::attributes_key(bucket_id.value(), file_name.value());
+    std::vector<uint8_t> cached;
+    KVError kv_err = edjx::kv::get(cached, cache_key);
+    if (kv_err == KVError::Success) {
+        FileAttributes cached_attributes;
+        if (edjsamples::kv_cache::decode_attributes(cached, cached_attributes)) {
+            std::string attr_res = to_json(cached_attributes);
+            info("Get Attributes Successful (KV), " + attr_res);
+            edjsamples::kv_cache::log_counters(true, false);
+            return HttpResponse(attr_res)
+                .set_status(HTTP_STATUS_OK)
+                .set_header("X-Cache-Tier", "kv");
+        }
+        error("Ignoring a corrupt cache entry: " + cache_key);
+    } else if (kv_err != KVError::NotFound) {
+        error("Error in kv::get(): " + to_string(kv_err));
+    }
+
     FileAttributes res_bytes;
     StorageError err = get_attributes(res_bytes, bucket_id.value(), file_name.value());
     if (err != StorageError::Success) {
@@ -178,5 +137,14 @@ HttpResponse serverless(const HttpRequest & req) {
     std::string attr_res = to_json(res_bytes);
     info("Get Attributes Successful, " + attr_res);
 
-    return HttpResponse(attr_res).set_status(HTTP_STATUS_OK);
+    // Fill the cache. A failed fill does not fail the request.
+    kv_err = edjx::kv::put(cache_key, edjsamples::kv_cache::encode_attributes(res_bytes), ATTRIBUTES_CACHE_TTL_MS);
+    if (kv_err != KVError::Success) {
+        error("Error in kv::put(): " + to_string(kv_err));
+    }
+    edjsamples::kv_cache::log_counters(false, kv_err == KVError::Success);
+
+    return HttpResponse(attr_res)
+        .set_status(HTTP_STATUS_OK)
+        .set_header("X-Cache-Tier", "storage");
 }
\ No newline at end of file
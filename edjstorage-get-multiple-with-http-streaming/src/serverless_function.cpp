@@ -0,0 +1,228 @@
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <vector>
+#include <optional>
+
+#include <edjx/storage.hpp>
+#include <edjx/logger.hpp>
+#include <edjx/error.hpp>
+#include <edjx/request.hpp>
+#include <edjx/response.hpp>
+#include <edjx/http.hpp>
+#include <edjx/stream.hpp>
+
+#include <edjsamples/headers.hpp>
+#include <edjsamples/query.hpp>
+#include <edjsamples/stream.hpp>
+
+using edjx::request::HttpRequest;
+using edjx::response::HttpResponse;
+using edjx::error::HttpError;
+using edjx::error::StorageError;
+using edjx::error::StreamError;
+using edjx::storage::StorageResponse;
+using edjx::logger::info;
+using edjx::logger::error;
+using edjx::http::HttpStatusCode;
+using edjx::stream::ReadStream;
+using edjx::stream::WriteStream;
+using edjsamples::query::QueryParams;
+using edjsamples::stream::BufferedWriteStream;
+using edjsamples::stream::ByteSpan;
+using edjsamples::stream::ChunkPool;
+using edjsamples::stream::ChunkReader;
+
+static const HttpStatusCode HTTP_STATUS_OK = 200;
+static const HttpStatusCode HTTP_STATUS_BAD_REQUEST = 400;
+static const HttpStatusCode HTTP_STATUS_INTERNAL_SERVER_ERROR = 500;
+
+// Maximum number of files in one request
+static const size_t MAX_FILES = 64;
+
+// Number of files whose storage::get() has been issued but whose body has
+// not been sent yet. The SDK calls block and the function runs on a single
+// thread, so the reads cannot be awaited together; instead, the next files
+// are opened before the body of the current one is sent.
+static const size_t MAX_OPEN_READS = 4;
+
+// Capacity of the chunk buffer, allocated once per request
+static const size_t CHUNK_CAPACITY = 64 * 1024;
+
+// A storage::get() that has been issued for the `index`-th file
+struct OpenRead {
+    size_t index;
+    StorageError err;
+    StorageResponse response;
+};
+
+// Item header: "<index> <status> <length>\r\n"
+static StreamError write_item_header(BufferedWriteStream & out, size_t index, HttpStatusCode status, uint64_t length) {
+    return out.write(std::to_string(index) + " " + std::to_string(status) + " " + std::to_string(length) + "\r\n");
+}
+
+// Item whose body is known in full (an error message or a buffered file)
+static StreamError write_item(BufferedWriteStream & out, size_t index, HttpStatusCode status, ByteSpan body) {
+    StreamError err = write_item_header(out, index, status, body.size);
+    if (err == StreamError::Success) {
+        err = out.write(body.data, body.size);
+    }
+    if (err == StreamError::Success) {
+        err = out.write("\r\n");
+    }
+    return err;
+}
+
+// Sends the body of one file (or the error of its get) as an item of the
+// response
+//
+// Returns false if the item could not be sent completely. The length of the
+// item has been sent already, so the items after it could not be told
+// apart and the response has to be aborted.
+static bool send_file(BufferedWriteStream & out, ChunkPool & pool, OpenRead & read) {
+    if (read.err != StorageError::Success) {
+        error("Error in storage::get() of file " + std::to_string(read.index) + ": " + to_string(read.err));
+        std::string message = to_string(read.err);
+        return write_item(out, read.index, to_http_status_code(read.err), ByteSpan(message)) == StreamError::Success;
+    }
+
+    std::optional<uint64_t> size = edjsamples::headers::content_length(read.response.get_headers());
+    if (!size.has_value()) {
+        // Without the size, the body has to be read before the item header
+        // is written; a read error can then still be reported in the item
+        std::vector<uint8_t> body;
+        StreamError read_err = read.response.read_body(body);
+        if (read_err != StreamError::Success) {
+            error("Error when reading file " + std::to_string(read.index) + ": " + to_string(read_err));
+            std::string message = to_string(read_err);
+            return write_item(out, read.index, HTTP_STATUS_INTERNAL_SERVER_ERROR, ByteSpan(message))
+                == StreamError::Success;
+        }
+        return write_item(out, read.index, read.response.get_status_code(), ByteSpan(body.data(), body.size()))
+            == StreamError::Success;
+    }
+
+    ReadStream read_stream = read.response.get_read_stream();
+    if (write_item_header(out, read.index, read.response.get_status_code(), size.value()) != StreamError::Success) {
+        read_stream.close();
+        return false;
+    }
+    ChunkReader reader(read_stream, pool);
+    uint64_t sent = 0;
+    StreamError err;
+    ByteSpan chunk;
+    while ((err = reader.read(chunk)) == StreamError::Success) {
+        sent += chunk.size;
+        if (sent > size.value()) {
+            break;
+        }
+        err = out.write(chunk.data, chunk.size);
+        if (err != StreamError::Success) {
+            break;
+        }
+    }
+    read_stream.close();
+    if (err != StreamError::EndOfStream || sent != size.value()) {
+        error("File " + std::to_string(read.index) + " could not be sent: " + to_string(err)
+            + " after " + std::to_string(sent) + " of " + std::to_string(size.value()) + " bytes");
+        return false;
+    }
+    return out.write("\r\n") == StreamError::Success;
+}
+
+bool serverless_streaming(HttpRequest & req) {
+    info("** Storage get multiple files with http function - Streaming version **");
+
+    std::string uri = req.get_uri().as_string();
+    QueryParams query(uri);
+
+    // 1. param (required, repeated): "file_name" -> names of the files to get
+    size_t file_count = query.count_of("file_name");
+    if (file_count == 0 || file_count > MAX_FILES) {
+        std::string message = "Between 1 and " + std::to_string(MAX_FILES)
+            + " file_name parameters must be given in the query params of request";
+        error(message);
+        HttpResponse(message)
+            .set_status(HTTP_STATUS_BAD_REQUEST)
+            .send();
+        return false;
+    }
+    std::vector<std::string> file_names;
+    file_names.reserve(file_count);
+    for (size_t i = 0; i < file_count; i++) {
+        std::optional<std::string> file_name = query.get_decoded("file_name", i);
+        if (!file_name.has_value()) {
+            error("Malformed file_name in query params of request");
+            HttpResponse("Malformed file_name in query params of request")
+                .set_status(HTTP_STATUS_BAD_REQUEST)
+                .send();
+            return false;
+        }
+        file_names.push_back(std::move(file_name.value()));
+    }
+
+    // 2. param (required): "bucket_id" -> bucket that contains the files
+    std::optional<std::string> bucket_id = query.get_decoded("bucket_id");
+    if (!bucket_id.has_value()) {
+        error("No bucket id found in query params of request");
+        HttpResponse("No bucket id found in query params of request")
+            .set_status(HTTP_STATUS_BAD_REQUEST)
+            .send();
+        return false;
+    }
+
+    // Open a write stream for the response. The status of every file is
+    // sent in its item, so the response itself is always 200.
+    HttpResponse res;
+    res.set_status(HTTP_STATUS_OK);
+    res.set_header("Serverless", "EDJX");
+    res.set_header("Content-Type", "application/octet-stream");
+    WriteStream write_stream;
+    HttpError http_err = res.send_streaming(write_stream);
+    if (http_err != HttpError::Success) {
+        error("Could not open write stream: " + to_string(http_err));
+        return false;
+    }
+
+    // Items of small files are coalesced into few write_chunk() calls
+    BufferedWriteStream out(write_stream);
+    ChunkPool pool(1, CHUNK_CAPACITY);
+    std::deque<OpenRead> open_reads;
+    size_t next = 0;
+    size_t failed = 0;
+    while (next < file_names.size() || !open_reads.empty()) {
+        // Issue the gets of the next files, up to MAX_OPEN_READS at a time
+        while (next < file_names.size() && open_reads.size() < MAX_OPEN_READS) {
+            open_reads.emplace_back();
+            OpenRead & read = open_reads.back();
+            read.index = next;
+            read.err = edjx::storage::get(read.response, bucket_id.value(), file_names[next]);
+            next++;
+        }
+
+        OpenRead & read = open_reads.front();
+        if (read.err != StorageError::Success) {
+            failed++;
+        }
+        if (!send_file(out, pool, read)) {
+            open_reads.pop_front();
+            for (OpenRead & other : open_reads) {
+                if (other.err == StorageError::Success) {
+                    other.response.get_read_stream().close();
+                }
+            }
+            out.abort();
+            return false;
+        }
+        open_reads.pop_front();
+    }
+    info("Sent " + std::to_string(file_names.size()) + " files (" + std::to_string(failed) + " not found or failed)");
+
+    StreamError close_err = out.close();
+    if (close_err != StreamError::Success) {
+        error("Error when closing the write stream: " + to_string(close_err));
+        return false;
+    }
+
+    return true;
+}
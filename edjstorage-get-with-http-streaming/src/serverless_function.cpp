@@ -1,6 +1,9 @@
 #include <cstdint>
+#include <algorithm>
 #include <string>
+#include <string_view>
 #include <vector>
+#include <optional>
 
 #include <edjx/storage.hpp>
 #include <edjx/logger.hpp>
@@ -10,6 +13,14 @@
 #include <edjx/http.hpp>
 #include <edjx/stream.hpp>
 
+#include <edjsamples/conditional.hpp>
+#include <edjsamples/digest.hpp>
+#include <edjsamples/headers.hpp>
+#include <edjsamples/multipart.hpp>
+#include <edjsamples/query.hpp>
+#include <edjsamples/range.hpp>
+#include <edjsamples/stream.hpp>
+
 using edjx::request::HttpRequest;
 using edjx::response::HttpResponse;
 using edjx::error::HttpError;
@@ -22,65 +33,183 @@ using edjx::logger::error;
 using edjx::http::HttpStatusCode;
 using edjx::stream::ReadStream;
 using edjx::stream::WriteStream;
+using edjsamples::digest::Crc32c;
+using edjsamples::headers::HeaderIndex;
+using edjsamples::multipart::Manifest;
+using edjsamples::multipart::Part;
+using edjsamples::query::QueryParams;
+using edjsamples::range::ByteRange;
+using edjsamples::range::RangeStatus;
+using edjsamples::stream::ByteSpan;
+using edjsamples::stream::ChunkPool;
+using edjsamples::stream::ChunkReader;
+using edjsamples::stream::ChunkWriter;
 
 static const HttpStatusCode HTTP_STATUS_OK = 200;
+static const HttpStatusCode HTTP_STATUS_PARTIAL_CONTENT = 206;
 static const HttpStatusCode HTTP_STATUS_BAD_REQUEST = 400;
+static const HttpStatusCode HTTP_STATUS_RANGE_NOT_SATISFIABLE = 416;
+static const HttpStatusCode HTTP_STATUS_INTERNAL_SERVER_ERROR = 500;
 
-static std::optional<std::string> query_param_by_name(const HttpRequest & req, const std::string & param_name) {
-    std::string uri = req.get_uri().as_string();
-    std::vector<std::pair<std::string, std::string>> query_parsed;
-
-    // e.g., https://example.com/path/to/page?name=ferret&color=purple
-
-    size_t query_start = uri.find('?');
-
-    if (query_start != std::string::npos) {
-        // Query is present
-        std::string name;
-        std::string value;
-        bool parsing_name = true;
-        for (std::string::iterator it = uri.begin() + query_start + 1; it != uri.end(); ++it) {
-            char c = *it;
-            switch (c) {
-                case '?':
-                    break; // Invalid URI
-                case '=':
-                    parsing_name = false;
-                    break;
-                case '&':
-                    query_parsed.push_back(make_pair(name, value));
-                    name.clear();
-                    value.clear();
-                    parsing_name = true;
-                    break;
-                default:
-                    if (parsing_name) {
-                        name += c;
-                    } else {
-                        value += c;
-                    }
-                    break;
-            }
-        }
-        if (!name.empty() || !value.empty()) {
-            query_parsed.push_back(make_pair(name, value));
-        }
-
-        for (const auto & parameter : query_parsed) {
-            if (parameter.first == param_name) {
-                return parameter.second;
-            }
-        }
-    }
-
-    return {};
+// Capacity of the chunk buffers, allocated once per request
+static const size_t CHUNK_CAPACITY = 64 * 1024;
+
+// Position of the response in the file while the content is sent
+struct SendPosition {
+    uint64_t begin = 0;        // Offset of the first byte to send
+    uint64_t end = UINT64_MAX; // Offset of the byte after the last one to send
+    uint64_t offset = 0;       // Offset of the next byte read from the storage
+    int count = 0;             // Number of chunks read
+};
+
+// Sends the part of a chunk read at `position.offset` that is in the
+// requested range, and advances `position.offset` past the chunk
+//
+// A chunk before the range is skipped, and the chunks at its edges are
+// trimmed. Returns the write error (which is logged), if any.
+static StreamError send_chunk(
+    const std::vector<uint8_t> & chunk,
+    WriteStream & write_stream,
+    ChunkWriter & trimmed_writer,
+    SendPosition & position
+) {
+    position.count++;
+    uint64_t chunk_begin = position.offset;
+    uint64_t chunk_end = position.offset + chunk.size();
+    position.offset = chunk_end;
+    if (chunk_end <= position.begin || chunk_begin >= position.end) {
+        return StreamError::Success;
+    }
+
+    // Send the chunk (or its part in the range) in the HTTP response
+    StreamError write_err;
+    if (chunk_begin >= position.begin && chunk_end <= position.end) {
+        write_err = write_stream.write_chunk(chunk);
+    } else {
+        uint64_t skip = position.begin > chunk_begin ? position.begin - chunk_begin : 0;
+        uint64_t keep = std::min(chunk_end, position.end) - chunk_begin - skip;
+        write_err = trimmed_writer.write(ByteSpan(chunk.data() + skip, keep));
+    }
+    if (write_err != StreamError::Success) {
+        error("Error when writing a chunk: " + to_string(write_err));
+    }
+    return write_err;
+}
+
+// Sends the bytes of a read stream that are in the requested range
+//
+// `position.offset` is the offset in the file of the next byte of the
+// stream, and is advanced by the bytes read. Reading stops at the end of
+// the range. Every chunk read is added to `crc`, if given.
+//
+// Returns EndOfStream if the stream ended, Success if reading stopped at
+// the end of the range, or the error (which is logged).
+static StreamError send_stream(
+    ReadStream & read_stream,
+    ChunkPool & pool,
+    WriteStream & write_stream,
+    ChunkWriter & trimmed_writer,
+    SendPosition & position,
+    Crc32c * crc
+) {
+    ChunkReader reader(read_stream, pool);
+    StreamError read_err = StreamError::Success;
+    ByteSpan chunk;
+    while (position.offset < position.end && (read_err = reader.read(chunk)) == StreamError::Success) {
+        if (crc != nullptr) {
+            crc->update(chunk.data, chunk.size);
+        }
+        StreamError write_err = send_chunk(reader.last_chunk(), write_stream, trimmed_writer, position);
+        if (write_err != StreamError::Success) {
+            return write_err;
+        }
+    }
+    if (read_err != StreamError::Success && read_err != StreamError::EndOfStream) {
+        error("Error in read_chunk: " + to_string(read_err));
+    }
+    return read_err;
+}
+
+// Sends the parts of a multipart file that are in the requested range
+//
+// Parts before the range are not opened, and no part is opened after the
+// end of the range. A part that is read to its end must have the size and
+// CRC32C listed in the manifest; otherwise (e.g., the part was overwritten)
+// the response cannot be completed.
+static bool send_parts(
+    const std::string & bucket_id,
+    const Manifest & manifest,
+    ChunkPool & pool,
+    WriteStream & write_stream,
+    ChunkWriter & trimmed_writer,
+    SendPosition & position
+) {
+    uint64_t part_begin = 0;
+    for (const Part & part : manifest.parts) {
+        uint64_t part_end = part_begin + part.size;
+        position.offset = part_begin;
+        part_begin = part_end;
+        if (part_end <= position.begin) {
+            continue;
+        }
+        if (position.offset >= position.end) {
+            break;
+        }
+
+        StorageResponse part_res;
+        StorageError storage_err = edjx::storage::get(part_res, bucket_id, part.name);
+        if (storage_err != StorageError::Success) {
+            error("Error in storage::get() of part " + part.name + ": " + to_string(storage_err));
+            return false;
+        }
+        ReadStream part_stream = part_res.get_read_stream();
+        Crc32c crc;
+        StreamError send_err = send_stream(part_stream, pool, write_stream, trimmed_writer, position, &crc);
+        part_stream.close();
+        if (send_err != StreamError::Success && send_err != StreamError::EndOfStream) {
+            return false;
+        }
+        if (position.offset > part_end
+            || (send_err == StreamError::EndOfStream && (position.offset != part_end || crc.value() != part.crc32c))) {
+            error("Part " + part.name + " does not match the manifest");
+            return false;
+        }
+    }
+    return true;
+}
+
+// Reads the beginning of a file into `head`: the first chunk, and more
+// while the content can still be a manifest of parts (up to
+// MAX_MANIFEST_SIZE bytes)
+//
+// Returns EndOfStream if `head` is the whole file, Success if more content
+// follows, or the read error.
+static StreamError read_head(ReadStream & read_stream, std::vector<uint8_t> & head) {
+    StreamError read_err = read_stream.read_chunk(head);
+    if (read_err != StreamError::Success) {
+        head.clear();
+        return read_err;
+    }
+    std::vector<uint8_t> chunk;
+    while (head.size() <= edjsamples::multipart::MAX_MANIFEST_SIZE && edjsamples::multipart::looks_like_manifest(
+            std::string_view(reinterpret_cast<const char *>(head.data()), head.size()))) {
+        read_err = read_stream.read_chunk(chunk);
+        if (read_err != StreamError::Success) {
+            break;
+        }
+        head.insert(head.end(), chunk.begin(), chunk.end());
+    }
+    return read_err;
 }
 
 bool serverless_streaming(HttpRequest & req) {
     info("** Storage get with http function - Streaming version **");
 
+    std::string uri = req.get_uri().as_string();
+    QueryParams query(uri);
+
     // 1. param (required): "file_name" -> name that will be given to the uploaded content
-    std::optional<std::string> file_name = query_param_by_name(req, "file_name");
+    std::optional<std::string> file_name = query.get_decoded("file_name");
     if (!file_name.has_value()) {
         error("No file_name found in query params of request");
         HttpResponse("No file name found in query params of request")
@@ -90,7 +219,7 @@ bool serverless_streaming(HttpRequest & req) {
     }
 
     // 2. param (required): "bucket_id" -> in which bucket content will be uploaded
-    std::optional<std::string> bucket_id = query_param_by_name(req, "bucket_id");
+    std::optional<std::string> bucket_id = query.get_decoded("bucket_id");
     if (!bucket_id.has_value()) {
         error("No bucket id found in query params of request");
         HttpResponse("No bucket id found in query params of request")
@@ -99,9 +228,40 @@ bool serverless_streaming(HttpRequest & req) {
         return false;
     }
 
+    // 3. param (optional): "debug" -> "true" appends the number of received
+    // chunks after the content (the body is then not the file anymore)
+    bool debug = query.get_decoded("debug") == "true";
+
+    // The attributes of the file identify its current content
+    FileAttributes attributes;
+    StorageError storage_err = edjx::storage::get_attributes(attributes, bucket_id.value(), file_name.value());
+    if (storage_err != StorageError::Success) {
+        error("Error in storage::get_attributes(): " + to_string(storage_err));
+        HttpResponse(to_string(storage_err))
+            .set_status(to_http_status_code(storage_err))
+            .send();
+        return false;
+    }
+
+    // A client that revalidates an unchanged copy (If-None-Match) gets 304
+    // before the file is opened
+    std::optional<std::string> etag = edjsamples::conditional::entity_tag(attributes);
+    HeaderIndex request_headers(req.get_headers());
+    if (edjsamples::conditional::not_modified(request_headers, etag)) {
+        info("Not Modified");
+        HttpResponse res = edjsamples::conditional::not_modified_response(attributes, etag);
+        res.set_header("Serverless", "EDJX");
+        HttpError http_err = res.send();
+        if (http_err != HttpError::Success) {
+            error("Could not send the response: " + to_string(http_err));
+            return false;
+        }
+        return true;
+    }
+
     // Get the file from the storage
     StorageResponse storage_res;
-    StorageError storage_err = edjx::storage::get(storage_res, bucket_id.value(), file_name.value());
+    storage_err = edjx::storage::get(storage_res, bucket_id.value(), file_name.value());
     if (storage_err != StorageError::Success) {
         error("Error in storage::get(): " + to_string(storage_err));
         HttpResponse(to_string(storage_err))
@@ -111,70 +271,141 @@ bool serverless_streaming(HttpRequest & req) {
     }
     info("Get Content Successful");
 
-    // Open a read stream from the file
+    // Read the beginning of the file. The content of a multipart file
+    // (uploaded by edjstorage-put-with-http-streaming-userdata with
+    // "multipart=true") is the manifest of its parts, recognized by its
+    // format; the parts are sent in its place. Any other content is sent as
+    // it is, starting with the chunks read here.
+    // The chunks are read into reused buffers (the head, the reader, and the
+    // writer of trimmed chunks)
+    ChunkPool pool(3, CHUNK_CAPACITY);
     ReadStream read_stream = storage_res.get_read_stream();
+    std::vector<uint8_t> head = pool.acquire();
+    StreamError head_err = read_head(read_stream, head);
+    if (head_err != StreamError::Success && head_err != StreamError::EndOfStream) {
+        error("Error in read_chunk: " + to_string(head_err));
+        read_stream.close();
+        HttpResponse("Error when reading the file")
+            .set_status(HTTP_STATUS_INTERNAL_SERVER_ERROR)
+            .send();
+        return false;
+    }
+    std::optional<Manifest> manifest;
+    std::optional<uint64_t> file_size = edjsamples::headers::content_length(storage_res.get_headers());
+    if (head_err == StreamError::EndOfStream) {
+        std::string_view text(reinterpret_cast<const char *>(head.data()), head.size());
+        Manifest parsed;
+        if (edjsamples::multipart::looks_like_manifest(text) && edjsamples::multipart::parse(text, file_name.value(), parsed)) {
+            info("Multipart file with " + std::to_string(parsed.parts.size()) + " parts");
+            read_stream.close();
+            file_size = parsed.size;
+            manifest = std::move(parsed);
+        } else {
+            file_size = head.size();
+        }
+    }
+
+    // A single byte range can be requested with a Range header (e.g., to
+    // resume an interrupted download); the size of the file must be known.
+    // With an If-Range that does not match the file, the whole file is sent.
+    RangeStatus range_status = RangeStatus::Ignored;
+    ByteRange range;
+    std::optional<std::string_view> range_header = request_headers.first("range");
+    if (range_header.has_value() && file_size.has_value()
+        && edjsamples::conditional::range_allowed(request_headers, etag)) {
+        range_status = edjsamples::range::parse(range_header.value(), file_size.value(), range);
+    }
+
+    if (range_status == RangeStatus::Unsatisfiable) {
+        error("Range not satisfiable: " + std::string(range_header.value()));
+        if (!manifest.has_value()) {
+            read_stream.close();
+        }
+        HttpResponse("Range not satisfiable")
+            .set_status(HTTP_STATUS_RANGE_NOT_SATISFIABLE)
+            .set_header("Serverless", "EDJX")
+            .set_header("Content-Range", edjsamples::range::unsatisfied_content_range(file_size.value()))
+            .send();
+        return false;
+    }
 
     // Prepare a response
     HttpResponse res;
-    res.set_status(HTTP_STATUS_OK);
     res.set_header("Serverless", "EDJX");
+    res.set_header("Accept-Ranges", "bytes");
+    edjsamples::conditional::set_validators(res, etag);
+    if (range_status == RangeStatus::Satisfiable) {
+        res.set_status(HTTP_STATUS_PARTIAL_CONTENT);
+        res.set_header("Content-Range", edjsamples::range::content_range(range, file_size.value()));
+    } else {
+        res.set_status(HTTP_STATUS_OK);
+    }
 
     // Open a write stream for the response
     WriteStream write_stream;
     HttpError http_err = res.send_streaming(write_stream);
     if (http_err != HttpError::Success) {
         error("Could not open write stream: " + to_string(http_err));
-        read_stream.close();
+        if (!manifest.has_value()) {
+            read_stream.close();
+        }
         return false;
     }
 
-    // Read the file chunk by chunk
-    int count = 0;
-    StreamError read_err;
-    std::vector<uint8_t> chunk;
-    while ((read_err = read_stream.read_chunk(chunk)) == StreamError::Success) {
-        count++;
-        // Send the chunk in the HTTP response
-        StreamError write_err = write_stream.write_chunk(chunk);
-        if (write_err != StreamError::Success) {
-            error("Error when writing a chunk: " + to_string(write_err));
+    // Offsets in the file of the first byte to send and of the byte after
+    // the last one
+    SendPosition position;
+    if (range_status == RangeStatus::Satisfiable) {
+        position.begin = range.first;
+        position.end = range.last + 1;
+    }
+
+    // Read the file (or its parts) chunk by chunk
+    ChunkWriter trimmed_writer(write_stream, pool);
+    bool retval = true;
+    if (manifest.has_value()) {
+        if (!send_parts(bucket_id.value(), manifest.value(), pool, write_stream, trimmed_writer, position)) {
+            write_stream.abort();
+            return false;
+        }
+    } else {
+        StreamError send_err = StreamError::Success;
+        if (!head.empty()) {
+            send_err = send_chunk(head, write_stream, trimmed_writer, position);
+        }
+        if (send_err == StreamError::Success && head_err == StreamError::Success) {
+            send_err = send_stream(read_stream, pool, write_stream, trimmed_writer, position, nullptr);
+        }
+        if (send_err != StreamError::Success && send_err != StreamError::EndOfStream) {
             read_stream.close();
             write_stream.abort();
             return false;
         }
-    }
 
-    if (read_err != StreamError::EndOfStream) {
-        error("Error in read_chunk: " + to_string(read_err));
-        read_stream.close();
-        write_stream.abort();
-        return false;
-    }
-
-    // Send some statistics at the end
-    StreamError write_err = write_stream.write_chunk(
-        "\nEnd of stream. Received " + std::to_string(count) + " chunks."
-    );
-    if (write_err != StreamError::Success) {
-        error("Error when writing a text chunk: " + to_string(write_err));
-        read_stream.close();
-        write_stream.abort();
-        return false;
+        StreamError close_err = read_stream.close();
+        if (close_err != StreamError::Success) {
+            error("Error when closing the read stream: " + to_string(close_err));
+            retval = false;
+        }
     }
 
-    bool retval = true;
-
-    StreamError close_err = read_stream.close();
-    if (close_err != StreamError::Success) {
-        error("Error when closing the read stream: " + to_string(close_err));
-        retval = false;
+    // Send some statistics at the end (debug mode only)
+    if (debug) {
+        StreamError write_err = write_stream.write_chunk(
+            "\nEnd of stream. Received " + std::to_string(position.count) + " chunks."
+        );
+        if (write_err != StreamError::Success) {
+            error("Error when writing a text chunk: " + to_string(write_err));
+            write_stream.abort();
+            return false;
+        }
     }
 
-    close_err = write_stream.close();
+    StreamError close_err = write_stream.close();
     if (close_err != StreamError::Success) {
         error("Error when closing the write stream: " + to_string(close_err));
         retval = false;
     }
 
     return retval;
-}
\ No newline at end of file
+}
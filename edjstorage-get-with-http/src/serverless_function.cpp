@@ -1,83 +1,123 @@
 #include <cstdint>
 #include <string>
+#include <string_view>
 #include <vector>
+#include <optional>
 #include <map>
 
 #include <edjx/storage.hpp>
+#include <edjx/kv.hpp>
 #include <edjx/logger.hpp>
 #include <edjx/error.hpp>
 #include <edjx/request.hpp>
 #include <edjx/response.hpp>
 #include <edjx/http.hpp>
 
+#include <edjsamples/conditional.hpp>
+#include <edjsamples/headers.hpp>
+#include <edjsamples/kv_cache.hpp>
+#include <edjsamples/query.hpp>
+
 using edjx::request::HttpRequest;
 using edjx::response::HttpResponse;
 using edjx::error::StorageError;
+using edjx::error::KVError;
 using edjx::error::StreamError;
 using edjx::storage::StorageResponse;
 using edjx::storage::FileAttributes;
 using edjx::logger::info;
 using edjx::logger::error;
 using edjx::http::HttpStatusCode;
+using edjx::http::HttpHeaders;
+using edjsamples::headers::HeaderIndex;
+using edjsamples::kv_cache::Encoder;
+using edjsamples::kv_cache::Decoder;
+using edjsamples::query::QueryParams;
 
 static const HttpStatusCode HTTP_STATUS_OK = 200;
 static const HttpStatusCode HTTP_STATUS_BAD_REQUEST = 400;
 
-std::optional<std::string> query_param_by_name(const HttpRequest & req, const std::string & param_name) {
-    std::string uri = req.get_uri().as_string();
-    std::vector<std::pair<std::string, std::string>> query_parsed;
-
-    // e.g., https://example.com/path/to/page?name=ferret&color=purple
-
-    size_t query_start = uri.find('?');
-
-    if (query_start != std::string::npos) {
-        // Query is present
-        std::string name;
-        std::string value;
-        bool parsing_name = true;
-        for (std::string::iterator it = uri.begin() + query_start + 1; it != uri.end(); ++it) {
-            char c = *it;
-            switch (c) {
-                case '?':
-                    break; // Invalid URI
-                case '=':
-                    parsing_name = false;
-                    break;
-                case '&':
-                    query_parsed.push_back(make_pair(name, value));
-                    name.clear();
-                    value.clear();
-                    parsing_name = true;
-                    break;
-                default:
-                    if (parsing_name) {
-                        name += c;
-                    } else {
-                        value += c;
-                    }
-                    break;
-            }
-        }
-        if (!name.empty() || !value.empty()) {
-            query_parsed.push_back(make_pair(name, value));
+// Objects up to this size are copied to the KV store when they are read
+// from the storage; larger objects are always read from the storage
+static const uint64_t MAX_CACHED_OBJECT_SIZE = 64 * 1024;
+
+// Time to live of the cached copies in milliseconds. A new version of a
+// file has a new cache key, so this only bounds how long stale versions
+// take up space in the KV store.
+static const uint64_t CACHE_TTL_MS = 10 * 60 * 1000;
+
+// Format of the cached values; change it when the encoding changes
+static const uint64_t CACHE_FORMAT = 1;
+
+// Cached value: the format, the headers of the storage response, and the body
+static std::vector<uint8_t> encode_cached_object(const HttpHeaders & headers, const std::vector<uint8_t> & body) {
+    Encoder encoder;
+    encoder.reserve(body.size() + 256);
+    encoder.put_uint(CACHE_FORMAT);
+    encoder.put_uint(headers.size());
+    for (const auto & header : headers) {
+        encoder.put_bytes(header.first);
+        encoder.put_uint(header.second.size());
+        for (const std::string & value : header.second) {
+            encoder.put_bytes(value);
         }
+    }
+    encoder.put_bytes(body.data(), body.size());
+    return encoder.bytes();
+}
 
-        for (const auto & parameter : query_parsed) {
-            if (parameter.first == param_name) {
-                return parameter.second;
+// Returns false if the cached value is corrupt or in another format
+static bool decode_cached_object(const std::vector<uint8_t> & value, HttpHeaders & headers, std::vector<uint8_t> & body) {
+    Decoder decoder(value);
+    uint64_t format;
+    uint64_t header_count;
+    if (!decoder.get_uint(format) || format != CACHE_FORMAT || !decoder.get_uint(header_count)) {
+        return false;
+    }
+    for (uint64_t i = 0; i < header_count; i++) {
+        std::string_view name;
+        uint64_t value_count;
+        if (!decoder.get_bytes(name) || !decoder.get_uint(value_count)) {
+            return false;
+        }
+        std::vector<std::string> & values = headers[std::string(name)];
+        for (uint64_t j = 0; j < value_count; j++) {
+            std::string_view header_value;
+            if (!decoder.get_bytes(header_value)) {
+                return false;
             }
+            values.emplace_back(header_value);
         }
     }
+    std::string_view cached_body;
+    if (!decoder.get_bytes(cached_body) || !decoder.done()) {
+        return false;
+    }
+    body.assign(cached_body.begin(), cached_body.end());
+    return true;
+}
+
+// `tier` is "kv" or "storage", whichever served the body
+static HttpResponse object_response(const HttpHeaders & headers, const std::vector<uint8_t> & body, const char * tier) {
+    HttpResponse res(body);
+    for (const auto & header : headers) {
+        res.append_header(header.first, header.second);
+    }
 
-    return {};
+    return res
+        .set_status(HTTP_STATUS_OK)
+        .set_header("Content-Type", "text/plain")
+        .set_header("X-Cache-Tier", tier);
 }
 
 HttpResponse serverless(const HttpRequest & req) {
     info("**Storage get with http function**");
 
+    std::string uri = req.get_uri().as_string();
+    QueryParams query(uri);
+
     // 1. param (required): "file_name" -> name that will be given to the uploaded content
-    std::optional<std::string> file_name = query_param_by_name(req, "file_name");
+    std::optional<std::string> file_name = query.get_decoded("file_name");
     if (!file_name.has_value()) {
         error("No file_name found in query params of request");
         return HttpResponse("No file name found in query params of request")
@@ -85,15 +125,58 @@ HttpResponse serverless(const HttpRequest & req) {
     }
 
     // 2. param (required): "bucket_id" -> in which bucket content will be uploaded
-    std::optional<std::string> bucket_id = query_param_by_name(req, "bucket_id");
+    std::optional<std::string> bucket_id = query.get_decoded("bucket_id");
     if (!bucket_id.has_value()) {
         error("No bucket id found in query params of request");
         return HttpResponse("No bucket id found in query params of request")
             .set_status(HTTP_STATUS_BAD_REQUEST);
     }
 
+    // The attributes of the file identify its current content
+    FileAttributes attributes;
+    StorageError err = edjx::storage::get_attributes(attributes, bucket_id.value(), file_name.value());
+    if (err != StorageError::Success) {
+        return HttpResponse(to_string(err)).set_status(edjx::error::to_http_status_code(err));
+    }
+
+    // A client that revalidates an unchanged copy (If-None-Match) gets 304
+    // without the content being read
+    std::optional<std::string> etag = edjsamples::conditional::entity_tag(attributes);
+    HeaderIndex request_headers(req.get_headers());
+    if (edjsamples::conditional::not_modified(request_headers, etag)) {
+        info("Not Modified");
+        return edjsamples::conditional::not_modified_response(attributes, etag);
+    }
+
+    // The cache key includes the current version of the file, so a new
+    // upload is never served from an old cached copy. Files without a
+    // version are not cached.
+    std::optional<std::string> cache_key;
+    if (attributes.default_version_present && !attributes.default_version.empty()) {
+        cache_key = edjsamples::kv_cache::key("object", bucket_id.value(), attributes.default_version, file_name.value());
+    }
+
+    // Serve the object from the KV store if it is cached there
+    if (cache_key.has_value()) {
+        std::vector<uint8_t> cached;
+        KVError kv_err = edjx::kv::get(cached, cache_key.value());
+        if (kv_err == KVError::Success) {
+            HttpHeaders headers;
+            std::vector<uint8_t> body;
+            if (decode_cached_object(cached, headers, body)) {
+                info("Get Content Successful (KV)");
+                edjsamples::kv_cache::log_counters(true, false);
+                HttpResponse res = object_response(headers, body, "kv");
+                return edjsamples::conditional::set_validators(res, etag);
+            }
+            error("Ignoring a corrupt cache entry: " + cache_key.value());
+        } else if (kv_err != KVError::NotFound) {
+            error("Error in kv::get(): " + to_string(kv_err));
+        }
+    }
+
     StorageResponse res_bytes;
-    StorageError err = edjx::storage::get(res_bytes, bucket_id.value(), file_name.value());
+    err = edjx::storage::get(res_bytes, bucket_id.value(), file_name.value());
     if (err != StorageError::Success) {
         return HttpResponse(to_string(err)).set_status(edjx::error::to_http_status_code(err));
     }
@@ -107,12 +190,23 @@ HttpResponse serverless(const HttpRequest & req) {
             .set_status(HTTP_STATUS_BAD_REQUEST);
     }
 
-    HttpResponse res(body);
-    for (const auto & header : res_bytes.get_headers()) {
-        res.append_header(header.first, header.second);
+    // Fill the cache with small objects. A failed fill does not fail the
+    // request; the object is read from the storage again next time.
+    bool filled = false;
+    if (cache_key.has_value() && body.size() <= MAX_CACHED_OBJECT_SIZE) {
+        KVError kv_err = edjx::kv::put(
+            cache_key.value(),
+            encode_cached_object(res_bytes.get_headers(), body),
+            CACHE_TTL_MS
+        );
+        if (kv_err == KVError::Success) {
+            filled = true;
+        } else {
+            error("Error in kv::put(): " + to_string(kv_err));
+        }
     }
+    edjsamples::kv_cache::log_counters(false, filled);
 
-    return res
-        .set_status(HTTP_STATUS_OK)
-        .set_header("Content-Type", "text/plain");
-}
\ No newline at end of file
+    HttpResponse res = object_response(res_bytes.get_headers(), body, "storage");
+    return edjsamples::conditional::set_validators(res, etag);
+}
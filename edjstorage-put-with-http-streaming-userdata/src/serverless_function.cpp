@@ -1,9 +1,14 @@
 #include <cstdint>
+#include <cstdio>
+#include <chrono>
+#include <map>
 #include <string>
+#include <string_view>
 #include <vector>
 #include <optional>
 
 #include <edjx/storage.hpp>
+#include <edjx/kv.hpp>
 #include <edjx/logger.hpp>
 #include <edjx/error.hpp>
 #include <edjx/request.hpp>
@@ -12,78 +17,128 @@
 #include <edjx/http.hpp>
 #include <edjx/stream.hpp>
 
+#include <edjsamples/compress.hpp>
+#include <edjsamples/digest.hpp>
+#include <edjsamples/headers.hpp>
+#include <edjsamples/kv_cache.hpp>
+#include <edjsamples/multipart.hpp>
+#include <edjsamples/progress.hpp>
+#include <edjsamples/query.hpp>
+#include <edjsamples/stream.hpp>
+
 using edjx::request::HttpRequest;
 using edjx::response::HttpResponse;
 using edjx::error::HttpError;
 using edjx::error::StorageError;
 using edjx::error::StreamError;
-using edjx::storage::StorageResponsePending;
+using edjx::error::KVError;
 using edjx::storage::StorageResponse;
+using edjx::storage::FileAttributes;
 using edjx::stream::ReadStream;
 using edjx::stream::WriteStream;
 using edjx::logger::info;
 using edjx::logger::error;
 using edjx::http::HttpStatusCode;
+using edjsamples::compress::DecompressWriteStream;
+using edjsamples::compress::Encoding;
+using edjsamples::digest::DigestWriteStream;
+using edjsamples::headers::HeaderIndex;
+using edjsamples::multipart::MultipartWriteStream;
+using edjsamples::progress::ProgressReporter;
+using edjsamples::query::QueryParams;
+using edjsamples::stream::ByteSpan;
+using edjsamples::stream::ChunkPool;
+using edjsamples::stream::ChunkReader;
 
 static const HttpStatusCode HTTP_STATUS_OK = 200;
 static const HttpStatusCode HTTP_STATUS_BAD_REQUEST = 400;
+static const HttpStatusCode HTTP_STATUS_UNSUPPORTED_MEDIA_TYPE = 415;
 static const HttpStatusCode HTTP_STATUS_INTERNAL_SERVER_ERROR = 500;
 
-static std::optional<std::string> query_param_by_name(const HttpRequest & req, const std::string & param_name) {
-    std::string uri = req.get_uri().as_string();
-    std::vector<std::pair<std::string, std::string>> query_parsed;
-
-    // e.g., https://example.com/path/to/page?name=ferret&color=purple
-
-    size_t query_start = uri.find('?');
-
-    if (query_start != std::string::npos) {
-        // Query is present
-        std::string name;
-        std::string value;
-        bool parsing_name = true;
-        for (std::string::iterator it = uri.begin() + query_start + 1; it != uri.end(); ++it) {
-            char c = *it;
-            switch (c) {
-                case '?':
-                    break; // Invalid URI
-                case '=':
-                    parsing_name = false;
-                    break;
-                case '&':
-                    query_parsed.push_back(make_pair(name, value));
-                    name.clear();
-                    value.clear();
-                    parsing_name = true;
-                    break;
-                default:
-                    if (parsing_name) {
-                        name += c;
-                    } else {
-                        value += c;
-                    }
-                    break;
-            }
+// Capacity of the chunk buffers, allocated once per request
+static const size_t CHUNK_CAPACITY = 64 * 1024;
+
+// A progress update is sent to the client after every PROGRESS_BYTE_INTERVAL
+// uploaded bytes or PROGRESS_TIME_INTERVAL, whichever comes first
+static const uint64_t PROGRESS_BYTE_INTERVAL = 1024 * 1024;
+static const std::chrono::milliseconds PROGRESS_TIME_INTERVAL(1000);
+
+// Uploads with "Content-Encoding: gzip" or "deflate" are stored decompressed.
+// Uploads that decompress to more bytes (e.g., decompression bombs) fail.
+static const uint64_t MAX_DECOMPRESSED_SIZE = 1024ULL * 1024 * 1024;
+
+// With the "multipart=true" query parameter, the upload is stored in parts
+// of MULTIPART_PART_SIZE bytes and a manifest, with up to
+// MAX_PARTS_IN_FLIGHT part uploads pending at a time
+static const uint64_t MULTIPART_PART_SIZE = 8 * 1024 * 1024;
+static const size_t MAX_PARTS_IN_FLIGHT = 4;
+
+typedef DigestWriteStream<MultipartWriteStream> UploadDigestStream;
+typedef DecompressWriteStream<UploadDigestStream> UploadDecompressor;
+
+// Parses properties in the format of the "properties" query parameter
+// (e.g., "cache-control=true,a=b")
+static std::map<std::string, std::string> parse_properties(const std::string & properties) {
+    std::map<std::string, std::string> result;
+    size_t begin = 0;
+    while (begin < properties.size()) {
+        size_t end = properties.find(',', begin);
+        if (end == std::string::npos) {
+            end = properties.size();
         }
-        if (!name.empty() || !value.empty()) {
-            query_parsed.push_back(make_pair(name, value));
+        std::string property = properties.substr(begin, end - begin);
+        size_t eq = property.find('=');
+        if (!property.empty()) {
+            result[property.substr(0, eq)] = eq == std::string::npos ? "" : property.substr(eq + 1);
         }
+        begin = end + 1;
+    }
+    return result;
+}
 
-        for (const auto & parameter : query_parsed) {
-            if (parameter.first == param_name) {
-                return parameter.second;
-            }
-        }
+// Describes an error of writing the uploaded content to the storage
+static std::string upload_error(
+    StreamError err,
+    const MultipartWriteStream & storage_upload,
+    const UploadDecompressor * decompressor
+) {
+    if (storage_upload.storage_error() != StorageError::Success) {
+        return "Error when uploading to the storage: " + to_string(storage_upload.storage_error());
     }
+    if (decompressor != nullptr && decompressor->too_large()) {
+        return "Decompressed content exceeds the limit of " + std::to_string(MAX_DECOMPRESSED_SIZE) + " bytes";
+    }
+    if (decompressor != nullptr && err == StreamError::InvalidChunk) {
+        return "Invalid compressed content";
+    }
+    return "Error when writing a chunk to the storage: " + to_string(err);
+}
 
-    return {};
+// Compression ratio of an upload, e.g., "3.42"
+static std::string compression_ratio(uint64_t compressed_size, uint64_t decompressed_size) {
+    char ratio[32];
+    snprintf(ratio, sizeof(ratio), "%.2f",
+        compressed_size == 0 ? 0.0 : static_cast<double>(decompressed_size) / compressed_size);
+    return ratio;
+}
+
+// Sends the current upload progress to the client
+//
+// An update is formatted on the stack and written as a short string; the
+// pooled chunk buffers are kept for the uploaded content.
+static StreamError send_progress(WriteStream & client_write_stream, const ProgressReporter & progress) {
+    char update[ProgressReporter::MAX_UPDATE_SIZE];
+    return client_write_stream.write_chunk(std::string(progress.format(update)));
 }
 
 bool serverless_streaming(HttpRequest & req) {
     info("** Storage put - Streaming version with custom data **");
 
+    std::string uri = req.get_uri().as_string();
+    QueryParams query(uri);
+
     // 1. param (required): "file_name" -> name that will be given to the uploaded content
-    std::optional<std::string> file_name = query_param_by_name(req, "file_name");
+    std::optional<std::string> file_name = query.get_decoded("file_name");
     if (!file_name.has_value()) {
         error("No file name found in query params of the request");
         HttpResponse("No file name found in query params of the request")
@@ -94,7 +149,7 @@ bool serverless_streaming(HttpRequest & req) {
     }
 
     // 2. param (required): "bucket_id" -> in which bucket content will be uploaded
-    std::optional<std::string> bucket_id = query_param_by_name(req, "bucket_id");
+    std::optional<std::string> bucket_id = query.get_decoded("bucket_id");
     if (!bucket_id.has_value()) {
         error("No bucket id found in query params of the request");
         HttpResponse("No bucket id found in query params of the request")
@@ -105,7 +160,38 @@ bool serverless_streaming(HttpRequest & req) {
     }
 
     // 3. param (optional): "properties" -> e.g., cache-control=true,a=b
-    std::optional<std::string> properties = query_param_by_name(req, "properties");
+    std::optional<std::string> properties = query.get_decoded("properties");
+    std::map<std::string, std::string> file_properties = parse_properties(properties.value_or(""));
+
+    // The manifest property is set by this function on multipart uploads only
+    if (file_properties.count(edjsamples::multipart::MANIFEST_PROPERTY) != 0) {
+        std::string message = "The " + std::string(edjsamples::multipart::MANIFEST_PROPERTY)
+            + " property cannot be set in the properties param of the request";
+        error(message);
+        HttpResponse(message)
+            .set_status(HTTP_STATUS_BAD_REQUEST)
+            .set_header("Serverless", "EDJX")
+            .send();
+        return false;
+    }
+
+    // 4. param (optional): "multipart" -> "true" stores the upload in parts
+    bool multipart = query.get_decoded("multipart") == "true";
+
+    // A compressed upload is decompressed before it is stored
+    HeaderIndex request_headers(req.get_headers());
+    std::optional<std::string_view> content_encoding_header = request_headers.first("content-encoding");
+    std::optional<Encoding> content_encoding =
+        edjsamples::compress::parse_content_encoding(content_encoding_header.value_or(""));
+    if (!content_encoding.has_value()) {
+        error("Unsupported content encoding: " + std::string(content_encoding_header.value()));
+        HttpResponse("Unsupported content encoding: " + std::string(content_encoding_header.value()))
+            .set_status(HTTP_STATUS_UNSUPPORTED_MEDIA_TYPE)
+            .set_header("Serverless", "EDJX")
+            .set_header("Accept-Encoding", "gzip, deflate")
+            .send();
+        return false;
+    }
 
     // Open a read stream from the HTTP request from the client
     ReadStream client_read_stream;
@@ -119,16 +205,16 @@ bool serverless_streaming(HttpRequest & req) {
         return false;
     }
 
-    // Open a write stream to the storage
-    StorageResponsePending storage_resp_pending;
-    WriteStream storage_write_stream;
-    StorageError storage_write_open_err = edjx::storage::put_streaming(
-        storage_resp_pending,
-        storage_write_stream,
+    // Open a write stream to the storage (to the first part in the
+    // multipart mode)
+    MultipartWriteStream storage_upload(
         bucket_id.value(),
         file_name.value(),
-        properties.value_or("")
+        properties.value_or(""),
+        multipart ? MULTIPART_PART_SIZE : 0,
+        MAX_PARTS_IN_FLIGHT
     );
+    StorageError storage_write_open_err = storage_upload.open();
     if (storage_write_open_err != StorageError::Success) {
         error("Error when creating a storage write stream: " + to_string(storage_write_open_err));
         client_read_stream.close();
@@ -139,6 +225,9 @@ bool serverless_streaming(HttpRequest & req) {
         return false;
     }
 
+    // Every chunk sent to the storage is also hashed
+    UploadDigestStream storage_digest_stream(storage_upload);
+
     // Prepare an HTTP response for the client
     HttpResponse res;
     res.set_status(HTTP_STATUS_OK);
@@ -150,7 +239,7 @@ bool serverless_streaming(HttpRequest & req) {
     if (client_write_open_err != HttpError::Success) {
         error("Error when creating a write stream for the HTTP response: " + to_string(client_write_open_err));
         client_read_stream.close();
-        storage_write_stream.abort();
+        storage_upload.abort();
         HttpResponse("Error when creating a write stream for the HTTP response: " + to_string(client_write_open_err))
             .set_status(HTTP_STATUS_INTERNAL_SERVER_ERROR)
             .set_header("Serverless", "EDJX")
@@ -158,39 +247,50 @@ bool serverless_streaming(HttpRequest & req) {
         return false;
     }
 
-    // Read the request chunk by chunk
-    int count = 0;
-    std::vector<uint8_t> bytes;
+    // Read the request chunk by chunk (one pooled buffer for the reader,
+    // one for the decompressor)
+    ChunkPool pool(2, CHUNK_CAPACITY);
+    ChunkReader client_reader(client_read_stream, pool);
+    ProgressReporter progress(PROGRESS_BYTE_INTERVAL, PROGRESS_TIME_INTERVAL);
+    std::optional<UploadDecompressor> decompressor;
+    if (content_encoding.value() != Encoding::Identity) {
+        decompressor.emplace(storage_digest_stream, pool, content_encoding.value(), MAX_DECOMPRESSED_SIZE);
+    }
+    ByteSpan chunk;
     StreamError client_read_err;
-    while ((client_read_err = client_read_stream.read_chunk(bytes)) == StreamError::Success) {
-        count++;
-        // Send the chunk to the storage
-        StreamError storage_write_err = storage_write_stream.write_chunk(bytes);
+    while ((client_read_err = client_reader.read(chunk)) == StreamError::Success) {
+        // Send the chunk (decompressed, if compressed) to the storage
+        StreamError storage_write_err = decompressor.has_value()
+            ? decompressor->write(chunk)
+            : storage_digest_stream.write_chunk(client_reader.last_chunk());
         if (storage_write_err != StreamError::Success) {
-            error("Error when writing a chunk to the storage: " + to_string(storage_write_err));
-
-            StreamError client_write_err = client_write_stream.write_chunk(
-                "Error when writing a chunk to the storage: " + to_string(storage_write_err) + "\r\n"
+            std::string message = upload_error(
+                storage_write_err,
+                storage_upload,
+                decompressor ? &decompressor.value() : nullptr
             );
+            error(message);
+
+            StreamError client_write_err = client_write_stream.write_chunk(message + "\r\n");
             if (client_write_err != StreamError::Success) {
                 error("Error when writing a response chunk: " + to_string(client_write_err));
             }
             client_read_stream.close();
-            storage_write_stream.abort();
+            storage_upload.abort();
             client_write_stream.close();
             return false;
         }
 
-        // Stream the chunk upload progress back to the client
-        StreamError client_write_err = client_write_stream.write_chunk(
-            "Sent chunk #" + std::to_string(count) + " of size " + std::to_string(bytes.size()) + "\r\n"
-        );
-        if (client_write_err != StreamError::Success) {
-            error("Error when writing a response chunk: " + to_string(client_write_err));
-            client_read_stream.close();
-            storage_write_stream.abort();
-            client_write_stream.close();
-            return false;
+        // Stream the upload progress back to the client, at most once per interval
+        if (progress.add(chunk.size)) {
+            StreamError client_write_err = send_progress(client_write_stream, progress);
+            if (client_write_err != StreamError::Success) {
+                error("Error when writing a response chunk: " + to_string(client_write_err));
+                client_read_stream.close();
+                storage_upload.abort();
+                client_write_stream.close();
+                return false;
+            }
         }
     }
     if (client_read_err != StreamError::EndOfStream) {
@@ -203,7 +303,7 @@ bool serverless_streaming(HttpRequest & req) {
             error("Error when writing a response chunk: " + to_string(client_write_err));
         }
         client_read_stream.close();
-        storage_write_stream.abort();
+        storage_upload.abort();
         client_write_stream.close();
         return false;
     }
@@ -214,25 +314,51 @@ bool serverless_streaming(HttpRequest & req) {
         error("Error when closing the read stream: " + to_string(client_read_close_err));
     }
 
-    // Report the end of the stream to the client
-    StreamError client_write_err = client_write_stream.write_chunk(
-        "End of stream\r\n"
-    );
+    // Write the rest of the decompressed content to the storage
+    if (decompressor.has_value()) {
+        StreamError storage_write_err = decompressor->finish();
+        if (storage_write_err != StreamError::Success) {
+            std::string message = upload_error(storage_write_err, storage_upload, &decompressor.value());
+            error(message);
+
+            StreamError client_write_err = client_write_stream.write_chunk(message + "\r\n");
+            if (client_write_err != StreamError::Success) {
+                error("Error when writing a response chunk: " + to_string(client_write_err));
+            }
+            storage_upload.abort();
+            client_write_stream.close();
+            return false;
+        }
+    }
+
+    // Report the progress since the last update and the end of the stream to the client
+    StreamError client_write_err = StreamError::Success;
+    if (progress.pending()) {
+        progress.mark_reported();
+        client_write_err = send_progress(client_write_stream, progress);
+    }
+    if (client_write_err == StreamError::Success) {
+        client_write_err = client_write_stream.write_chunk(
+            "End of stream\r\n"
+        );
+    }
     if (client_write_err != StreamError::Success) {
         error("Error when writing a response chunk: " + to_string(client_write_err));
-        storage_write_stream.abort();
+        storage_upload.abort();
         client_write_stream.close();
         return false;
     }
 
-    // Close the storage write stream
-    StreamError storage_write_close_err = storage_write_stream.close();
+    // Close the storage write stream (in the multipart mode, wait for the
+    // parts and upload the manifest)
+    StreamError storage_write_close_err = storage_upload.close();
     if (storage_write_close_err != StreamError::Success) {
-        error("Error when closing the storage write stream: " + to_string(storage_write_close_err));
+        std::string message = storage_upload.storage_error() != StorageError::Success
+            ? "Error when uploading to the storage: " + to_string(storage_upload.storage_error())
+            : "Error when closing the storage write stream: " + to_string(storage_write_close_err);
+        error(message);
 
-        StreamError client_write_err = client_write_stream.write_chunk(
-            "Error when closing the storage write stream: " + to_string(storage_write_close_err) + "\r\n"
-        );
+        StreamError client_write_err = client_write_stream.write_chunk(message + "\r\n");
         if (client_write_err != StreamError::Success) {
             error("Error when writing a chunk: " + to_string(client_write_err));
             client_write_stream.close();
@@ -243,7 +369,7 @@ bool serverless_streaming(HttpRequest & req) {
 
     // Get a response from the storage
     StorageResponse storage_resp;
-    StorageError storage_resp_err = storage_resp_pending.get_storage_response(storage_resp);
+    StorageError storage_resp_err = storage_upload.get_storage_response(storage_resp);
     if (storage_resp_err != StorageError::Success) {
         error("Storage response error: " + to_string(storage_resp_err));
 
@@ -283,6 +409,94 @@ bool serverless_streaming(HttpRequest & req) {
         return false;
     }
 
+    // Store the digests as properties of the file. The properties of an
+    // upload are passed when the upload starts, before the content is known,
+    // so they are replaced afterwards together with the requested ones.
+    std::string crc32c = storage_digest_stream.crc32c_hex();
+    std::string sha256 = storage_digest_stream.sha256_hex();
+    file_properties["crc32c"] = crc32c;
+    file_properties["sha256"] = sha256;
+    if (multipart) {
+        file_properties[edjsamples::multipart::MANIFEST_PROPERTY] = "1";
+    }
+    FileAttributes attributes = {true, file_properties, false, ""};
+
+    StorageResponse attributes_resp;
+    StorageError attributes_err = edjx::storage::set_attributes(
+        attributes_resp,
+        bucket_id.value(),
+        file_name.value(),
+        attributes
+    );
+    if (attributes_err != StorageError::Success) {
+        error("Error when storing the digests: " + to_string(attributes_err));
+
+        StreamError client_write_err = client_write_stream.write_chunk(
+            "Error when storing the digests: " + to_string(attributes_err) + "\r\n"
+        );
+        if (client_write_err != StreamError::Success) {
+            error("Error when writing a chunk: " + to_string(client_write_err));
+        }
+        client_write_stream.close();
+        return false;
+    }
+
+    // Remove the attributes cached by edjstorage-get-attributes, so the
+    // next lookup reads the digests from the storage
+    KVError kv_err = edjx::kv::remove(edjsamples::kv_cache::attributes_key(bucket_id.value(), file_name.value()));
+    if (kv_err != KVError::Success && kv_err != KVError::NotFound) {
+        error("Error when removing the cached attributes: " + to_string(kv_err));
+    }
+
+    // Return the digests to the client
+    client_write_err = client_write_stream.write_chunk(
+        "CRC32C: " + crc32c + "\r\nSHA-256: " + sha256 + "\r\n"
+    );
+    if (client_write_err != StreamError::Success) {
+        error("Error when writing a chunk: " + to_string(client_write_err));
+        client_write_stream.close();
+        return false;
+    }
+
+    // Report the number of parts of a multipart upload
+    if (multipart) {
+        client_write_err = client_write_stream.write_chunk(
+            "Stored in " + std::to_string(storage_upload.parts().size()) + " parts\r\n"
+        );
+        if (client_write_err != StreamError::Success) {
+            error("Error when writing a chunk: " + to_string(client_write_err));
+            client_write_stream.close();
+            return false;
+        }
+    }
+
+    // Report the parts of a previous multipart upload of the file that were
+    // removed (see MultipartWriteStream::get_storage_response)
+    if (storage_upload.removed_parts() > 0) {
+        client_write_err = client_write_stream.write_chunk(
+            "Removed " + std::to_string(storage_upload.removed_parts()) + " parts of the previous upload\r\n"
+        );
+        if (client_write_err != StreamError::Success) {
+            error("Error when writing a chunk: " + to_string(client_write_err));
+            client_write_stream.close();
+            return false;
+        }
+    }
+
+    // Report the compression ratio of a compressed upload
+    if (decompressor.has_value()) {
+        client_write_err = client_write_stream.write_chunk(
+            "Decompressed " + std::to_string(decompressor->bytes_in()) + " bytes to "
+            + std::to_string(decompressor->bytes_out()) + " bytes (compression ratio "
+            + compression_ratio(decompressor->bytes_in(), decompressor->bytes_out()) + ")\r\n"
+        );
+        if (client_write_err != StreamError::Success) {
+            error("Error when writing a chunk: " + to_string(client_write_err));
+            client_write_stream.close();
+            return false;
+        }
+    }
+
     // Close the HTTP response stream
     StreamError client_write_close_err = client_write_stream.close();
     if (client_write_close_err != StreamError::Success) {
@@ -1,5 +1,6 @@
 #include <cstdint>
 #include <string>
+#include <string_view>
 #include <vector>
 #include <optional>
 
@@ -12,6 +13,9 @@
 #include <edjx/http.hpp>
 #include <edjx/stream.hpp>
 
+#include <edjsamples/query.hpp>
+#include <edjsamples/stream.hpp>
+
 using edjx::request::HttpRequest;
 using edjx::response::HttpResponse;
 using edjx::error::StorageError;
@@ -23,66 +27,22 @@ using edjx::stream::WriteStream;
 using edjx::logger::info;
 using edjx::logger::error;
 using edjx::http::HttpStatusCode;
+using edjsamples::query::QueryParams;
+using edjsamples::stream::ChunkPool;
+using edjsamples::stream::ChunkWriter;
 
 static const HttpStatusCode HTTP_STATUS_OK = 200;
 static const HttpStatusCode HTTP_STATUS_BAD_REQUEST = 400;
 static const HttpStatusCode HTTP_STATUS_INTERNAL_SERVER_ERROR = 500;
 
-static std::optional<std::string> query_param_by_name(const HttpRequest & req, const std::string & param_name) {
-    std::string uri = req.get_uri().as_string();
-    std::vector<std::pair<std::string, std::string>> query_parsed;
-
-    // e.g., https://example.com/path/to/page?name=ferret&color=purple
-
-    size_t query_start = uri.find('?');
-
-    if (query_start != std::string::npos) {
-        // Query is present
-        std::string name;
-        std::string value;
-        bool parsing_name = true;
-        for (std::string::iterator it = uri.begin() + query_start + 1; it != uri.end(); ++it) {
-            char c = *it;
-            switch (c) {
-                case '?':
-                    break; // Invalid URI
-                case '=':
-                    parsing_name = false;
-                    break;
-                case '&':
-                    query_parsed.push_back(make_pair(name, value));
-                    name.clear();
-                    value.clear();
-                    parsing_name = true;
-                    break;
-                default:
-                    if (parsing_name) {
-                        name += c;
-                    } else {
-                        value += c;
-                    }
-                    break;
-            }
-        }
-        if (!name.empty() || !value.empty()) {
-            query_parsed.push_back(make_pair(name, value));
-        }
-
-        for (const auto & parameter : query_parsed) {
-            if (parameter.first == param_name) {
-                return parameter.second;
-            }
-        }
-    }
-
-    return {};
-}
-
 HttpResponse serverless(const HttpRequest & req) {
     info("** Storage put with http function - Streaming version **");
 
+    std::string uri = req.get_uri().as_string();
+    QueryParams query(uri);
+
     // 1. param (required): "file_name" -> name that will be given to the uploaded content
-    std::optional<std::string> file_name = query_param_by_name(req, "file_name");
+    std::optional<std::string> file_name = query.get_decoded("file_name");
     if (!file_name.has_value()) {
         error("No file_name found in query params of request");
         return HttpResponse("No file name found in query params of request")
@@ -91,7 +51,7 @@ HttpResponse serverless(const HttpRequest & req) {
     }
 
     // 2. param (required): "bucket_id" -> in which bucket content will be uploaded
-    std::optional<std::string> bucket_id = query_param_by_name(req, "bucket_id");
+    std::optional<std::string> bucket_id = query.get_decoded("bucket_id");
     if (!bucket_id.has_value()) {
         error("No bucket id found in query params of request");
         return HttpResponse("No bucket id found in query params of request")
@@ -100,7 +60,7 @@ HttpResponse serverless(const HttpRequest & req) {
     }
 
     // 3. param (optional): "properties" -> e.g., cache-control=true,a=b
-    std::optional<std::string> properties = query_param_by_name(req, "properties");
+    std::optional<std::string> properties = query.get_decoded("properties");
 
     // Create a write stream to the storage
     StorageResponsePending storage_resp_pending;
@@ -124,10 +84,14 @@ HttpResponse serverless(const HttpRequest & req) {
 
     bool success = true;
 
+    // The chunks are copied into a reused buffer instead of new strings; no
+    // chunk is longer than the content, so the buffer is sized to it
+    ChunkPool pool(1, content.size());
+    ChunkWriter writer(write_stream, pool);
+
     // Send chunks of increasing sizes (1, 2, 3, ...)
     for (int i = 0, len = 1; i < content.length(); i += len, len++) {
-        std::string chunk = content.substr(i, len);
-        StreamError err = write_stream.write_chunk(chunk);
+        StreamError err = writer.write(std::string_view(content).substr(i, len));
         if (err != StreamError::Success) {
             error("Error when writing a text chunk: " + to_string(err));
             success = false;
@@ -0,0 +1,68 @@
+#ifndef EDJX_ERROR_HPP
+#define EDJX_ERROR_HPP
+
+#include <string>
+
+#include <edjx/http.hpp>
+
+namespace edjx {
+namespace error {
+
+enum class HttpError {
+    Success = 0,
+    Unknown,
+    UnAuthorized,
+    MessageTooLarge,
+    InvalidMethod,
+    InvalidUri,
+    InvalidHeaderName,
+    InvalidHeaderValue,
+    InvalidStatusCode,
+    InvalidBody,
+    RequestFailed,
+    InvalidStream
+};
+
+enum class StreamError {
+    Success = 0,
+    Unknown,
+    EndOfStream,
+    StreamNotFound,
+    StreamClosed,
+    InvalidChunk,
+    WriteFailed,
+    ReadFailed
+};
+
+enum class StorageError {
+    Success = 0,
+    Unknown,
+    UnAuthorized,
+    MissingBucketID,
+    MissingFileName,
+    EmptyContent,
+    ContentNotFound,
+    InvalidAttributes,
+    InternalError
+};
+
+enum class KVError {
+    Success = 0,
+    Unknown,
+    UnAuthorized,
+    NotFound
+};
+
+std::string to_string(HttpError e);
+std::string to_string(StreamError e);
+std::string to_string(StorageError e);
+std::string to_string(KVError e);
+
+edjx::http::HttpStatusCode to_http_status_code(HttpError e);
+edjx::http::HttpStatusCode to_http_status_code(StorageError e);
+edjx::http::HttpStatusCode to_http_status_code(KVError e);
+
+} // namespace error
+} // namespace edjx
+
+#endif // EDJX_ERROR_HPP
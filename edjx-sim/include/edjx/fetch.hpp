@@ -0,0 +1,78 @@
+#ifndef EDJX_FETCH_HPP
+#define EDJX_FETCH_HPP
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <memory>
+
+#include <edjx/error.hpp>
+#include <edjx/http.hpp>
+#include <edjx/stream.hpp>
+
+namespace edjx {
+namespace fetch {
+
+namespace detail {
+struct PendingFetch;
+}
+
+class FetchResponse {
+public:
+    FetchResponse();
+
+    edjx::http::HttpStatusCode get_status_code() const;
+    const edjx::http::HttpHeaders & get_headers() const;
+
+    edjx::error::StreamError read_body(std::vector<uint8_t> & result);
+    edjx::stream::ReadStream get_read_stream();
+
+private:
+    friend class HttpFetch;
+    friend class FetchResponsePending;
+
+    edjx::http::HttpStatusCode status;
+    edjx::http::HttpHeaders headers;
+    edjx::stream::ReadStream read_stream;
+};
+
+class FetchResponsePending {
+public:
+    FetchResponsePending();
+
+    // Waits until the request body stream is closed and returns the response
+    edjx::error::HttpError get_fetch_response(FetchResponse & result);
+
+private:
+    friend class HttpFetch;
+
+    std::shared_ptr<detail::PendingFetch> pending;
+};
+
+// edjx-sim: requests never leave the host, they are answered by a loopback
+// origin (see the edjx-sim README).
+class HttpFetch {
+public:
+    HttpFetch(const edjx::http::Uri & uri, edjx::http::HttpMethod method);
+
+    HttpFetch & set_header(const std::string & name, const std::string & value);
+    HttpFetch & append_header(const std::string & name, const std::string & value);
+    HttpFetch & set_body(const std::vector<uint8_t> & body);
+
+    edjx::error::HttpError send(FetchResponse & result);
+    edjx::error::HttpError send_streaming(
+        FetchResponsePending & result,
+        edjx::stream::WriteStream & write_stream
+    );
+
+private:
+    edjx::http::Uri uri;
+    edjx::http::HttpMethod method;
+    edjx::http::HttpHeaders headers;
+    std::vector<uint8_t> body;
+};
+
+} // namespace fetch
+} // namespace edjx
+
+#endif // EDJX_FETCH_HPP
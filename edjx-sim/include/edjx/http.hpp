@@ -0,0 +1,49 @@
+#ifndef EDJX_HTTP_HPP
+#define EDJX_HTTP_HPP
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <map>
+#include <optional>
+
+namespace edjx {
+namespace http {
+
+typedef uint16_t HttpStatusCode;
+
+enum class HttpMethod {
+    NONE,
+    GET,
+    HEAD,
+    POST,
+    PUT,
+    DELETE,
+    CONNECT,
+    OPTIONS,
+    TRACE,
+    PATCH
+};
+
+// Header names are stored in lowercase, every name maps to all of its values
+typedef std::map<std::string, std::vector<std::string>> HttpHeaders;
+
+class Uri {
+public:
+    Uri();
+    Uri(const std::string & uri);
+    Uri(const char * uri);
+
+    const std::string & as_string() const;
+
+private:
+    std::string uri;
+};
+
+std::string to_string(HttpMethod method);
+HttpMethod method_from_string(const std::string & method);
+
+} // namespace http
+} // namespace edjx
+
+#endif // EDJX_HTTP_HPP
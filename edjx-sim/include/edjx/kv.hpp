@@ -0,0 +1,36 @@
+#ifndef EDJX_KV_HPP
+#define EDJX_KV_HPP
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <optional>
+
+#include <edjx/error.hpp>
+
+namespace edjx {
+namespace kv {
+
+// edjx-sim: the store lives in process memory; it can be seeded from and
+// persisted to $EDJX_SIM_KV_FILE (see the edjx-sim README).
+
+edjx::error::KVError get(std::vector<uint8_t> & result, const std::string & key);
+
+// `ttl` is given in milliseconds
+edjx::error::KVError put(
+    const std::string & key,
+    const std::string & value,
+    std::optional<uint64_t> ttl = std::nullopt
+);
+edjx::error::KVError put(
+    const std::string & key,
+    const std::vector<uint8_t> & value,
+    std::optional<uint64_t> ttl = std::nullopt
+);
+
+edjx::error::KVError remove(const std::string & key);
+
+} // namespace kv
+} // namespace edjx
+
+#endif // EDJX_KV_HPP
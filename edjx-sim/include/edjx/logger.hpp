@@ -0,0 +1,21 @@
+#ifndef EDJX_LOGGER_HPP
+#define EDJX_LOGGER_HPP
+
+#include <string>
+
+// edjx-sim: log messages are written to stderr with a level prefix.
+
+namespace edjx {
+namespace logger {
+
+void trace(const std::string & message);
+void debug(const std::string & message);
+void info(const std::string & message);
+void warn(const std::string & message);
+void error(const std::string & message);
+void fatal(const std::string & message);
+
+} // namespace logger
+} // namespace edjx
+
+#endif // EDJX_LOGGER_HPP
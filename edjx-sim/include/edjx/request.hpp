@@ -0,0 +1,40 @@
+#ifndef EDJX_REQUEST_HPP
+#define EDJX_REQUEST_HPP
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <edjx/error.hpp>
+#include <edjx/http.hpp>
+#include <edjx/stream.hpp>
+#include <edjx/utils.hpp>
+
+namespace edjx {
+namespace request {
+
+// edjx-sim: the client request is read from stdin as a raw HTTP/1.1 message.
+class HttpRequest {
+public:
+    HttpRequest();
+
+    static edjx::error::HttpError from_client(HttpRequest & result);
+
+    const edjx::http::Uri & get_uri() const;
+    edjx::http::HttpMethod get_method() const;
+    const edjx::http::HttpHeaders & get_headers() const;
+
+    edjx::error::HttpError read_body(std::vector<uint8_t> & result);
+    edjx::error::HttpError open_read_stream(edjx::stream::ReadStream & result);
+
+private:
+    edjx::http::Uri uri;
+    edjx::http::HttpMethod method;
+    edjx::http::HttpHeaders headers;
+    bool body_consumed;
+};
+
+} // namespace request
+} // namespace edjx
+
+#endif // EDJX_REQUEST_HPP
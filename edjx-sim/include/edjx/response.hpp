@@ -0,0 +1,49 @@
+#ifndef EDJX_RESPONSE_HPP
+#define EDJX_RESPONSE_HPP
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <edjx/error.hpp>
+#include <edjx/http.hpp>
+#include <edjx/stream.hpp>
+#include <edjx/utils.hpp>
+
+namespace edjx {
+namespace response {
+
+// edjx-sim: responses are written to stdout as raw HTTP/1.1 messages,
+// streamed responses use chunked transfer encoding.
+class HttpResponse {
+public:
+    HttpResponse();
+    HttpResponse(const std::string & text);
+    HttpResponse(const char * text);
+    HttpResponse(const std::vector<uint8_t> & data);
+
+    HttpResponse & set_status(edjx::http::HttpStatusCode status);
+    edjx::http::HttpStatusCode get_status() const;
+
+    HttpResponse & set_header(const std::string & name, const std::string & value);
+    HttpResponse & set_header(const std::string & name, const std::vector<std::string> & values);
+    HttpResponse & append_header(const std::string & name, const std::string & value);
+    HttpResponse & append_header(const std::string & name, const std::vector<std::string> & values);
+    HttpResponse & set_headers(const edjx::http::HttpHeaders & headers);
+    const edjx::http::HttpHeaders & get_headers() const;
+
+    HttpResponse & set_body(const std::vector<uint8_t> & data);
+
+    edjx::error::HttpError send();
+    edjx::error::HttpError send_streaming(edjx::stream::WriteStream & write_stream);
+
+private:
+    edjx::http::HttpStatusCode status;
+    edjx::http::HttpHeaders headers;
+    std::vector<uint8_t> body;
+};
+
+} // namespace response
+} // namespace edjx
+
+#endif // EDJX_RESPONSE_HPP
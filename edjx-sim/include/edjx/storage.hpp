@@ -0,0 +1,106 @@
+#ifndef EDJX_STORAGE_HPP
+#define EDJX_STORAGE_HPP
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <map>
+#include <memory>
+
+#include <edjx/error.hpp>
+#include <edjx/http.hpp>
+#include <edjx/stream.hpp>
+
+namespace edjx {
+namespace storage {
+
+struct FileAttributes {
+    bool properties_present;
+    std::map<std::string, std::string> properties;
+    bool default_version_present;
+    std::string default_version;
+};
+
+namespace detail {
+struct PendingPut;
+}
+
+class StorageResponse {
+public:
+    StorageResponse();
+
+    edjx::http::HttpStatusCode get_status_code() const;
+    const edjx::http::HttpHeaders & get_headers() const;
+
+    edjx::error::StreamError read_body(std::vector<uint8_t> & result);
+    edjx::stream::ReadStream get_read_stream();
+
+private:
+    friend struct Access;
+
+    edjx::http::HttpStatusCode status;
+    edjx::http::HttpHeaders headers;
+    edjx::stream::ReadStream read_stream;
+};
+
+class StorageResponsePending {
+public:
+    StorageResponsePending();
+
+    // Waits until the upload stream is closed and returns the response
+    edjx::error::StorageError get_storage_response(StorageResponse & result);
+
+private:
+    friend struct Access;
+
+    std::shared_ptr<detail::PendingPut> pending;
+};
+
+// edjx-sim: buckets are directories under $EDJX_SIM_STORAGE_DIR
+// (see the edjx-sim README).
+
+edjx::error::StorageError get(
+    StorageResponse & result,
+    const std::string & bucket_id,
+    const std::string & file_name
+);
+
+edjx::error::StorageError put(
+    StorageResponse & result,
+    const std::string & bucket_id,
+    const std::string & file_name,
+    const std::string & properties,
+    const std::vector<uint8_t> & contents
+);
+
+edjx::error::StorageError put_streaming(
+    StorageResponsePending & result,
+    edjx::stream::WriteStream & write_stream,
+    const std::string & bucket_id,
+    const std::string & file_name,
+    const std::string & properties
+);
+
+edjx::error::StorageError remove(
+    StorageResponse & result,
+    const std::string & bucket_id,
+    const std::string & file_name
+);
+
+edjx::error::StorageError get_attributes(
+    FileAttributes & result,
+    const std::string & bucket_id,
+    const std::string & file_name
+);
+
+edjx::error::StorageError set_attributes(
+    StorageResponse & result,
+    const std::string & bucket_id,
+    const std::string & file_name,
+    const FileAttributes & attributes
+);
+
+} // namespace storage
+} // namespace edjx
+
+#endif // EDJX_STORAGE_HPP
@@ -0,0 +1,75 @@
+#ifndef EDJX_STREAM_HPP
+#define EDJX_STREAM_HPP
+
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <vector>
+#include <memory>
+
+#include <edjx/error.hpp>
+
+namespace edjx {
+namespace stream {
+
+namespace detail {
+
+// Backing implementation of a ReadStream (client request body,
+// fetch response body, storage object, ...)
+class ReadSource {
+public:
+    virtual ~ReadSource() = default;
+    virtual edjx::error::StreamError read_chunk(std::vector<uint8_t> & chunk) = 0;
+    virtual edjx::error::StreamError close() = 0;
+};
+
+// Backing implementation of a WriteStream (client response body,
+// fetch request body, storage object, ...)
+class WriteSink {
+public:
+    virtual ~WriteSink() = default;
+    virtual edjx::error::StreamError write_chunk(const uint8_t * data, size_t size) = 0;
+    virtual edjx::error::StreamError close() = 0;
+    virtual edjx::error::StreamError abort() = 0;
+};
+
+} // namespace detail
+
+class WriteStream;
+
+class ReadStream {
+public:
+    ReadStream();
+    explicit ReadStream(std::shared_ptr<detail::ReadSource> source);
+
+    // Reads the next chunk into `chunk` (the previous content is replaced).
+    // Returns StreamError::EndOfStream when there is no more data.
+    edjx::error::StreamError read_chunk(std::vector<uint8_t> & chunk);
+    // Reads the remaining data of the stream into `data`.
+    edjx::error::StreamError read_all(std::vector<uint8_t> & data);
+    // Writes all remaining chunks into `write_stream` and closes both streams.
+    edjx::error::StreamError pipe_to(WriteStream & write_stream);
+    edjx::error::StreamError close();
+
+private:
+    std::shared_ptr<detail::ReadSource> source;
+};
+
+class WriteStream {
+public:
+    WriteStream();
+    explicit WriteStream(std::shared_ptr<detail::WriteSink> sink);
+
+    edjx::error::StreamError write_chunk(const std::vector<uint8_t> & data);
+    edjx::error::StreamError write_chunk(const std::string & text);
+    edjx::error::StreamError close();
+    edjx::error::StreamError abort();
+
+private:
+    std::shared_ptr<detail::WriteSink> sink;
+};
+
+} // namespace stream
+} // namespace edjx
+
+#endif // EDJX_STREAM_HPP
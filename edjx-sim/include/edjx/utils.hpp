@@ -0,0 +1,17 @@
+#ifndef EDJX_UTILS_HPP
+#define EDJX_UTILS_HPP
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace edjx {
+namespace utils {
+
+std::string to_string(const std::vector<uint8_t> & bytes);
+std::vector<uint8_t> to_bytes(const std::string & str);
+
+} // namespace utils
+} // namespace edjx
+
+#endif // EDJX_UTILS_HPP
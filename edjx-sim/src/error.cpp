@@ -0,0 +1,109 @@
+#include <edjx/error.hpp>
+
+using edjx::http::HttpStatusCode;
+
+namespace edjx {
+namespace error {
+
+std::string to_string(HttpError e) {
+    switch (e) {
+        case HttpError::Success: return "Success";
+        case HttpError::Unknown: return "Unknown error";
+        case HttpError::UnAuthorized: return "Unauthorized";
+        case HttpError::MessageTooLarge: return "Message too large";
+        case HttpError::InvalidMethod: return "Invalid HTTP method";
+        case HttpError::InvalidUri: return "Invalid URI";
+        case HttpError::InvalidHeaderName: return "Invalid header name";
+        case HttpError::InvalidHeaderValue: return "Invalid header value";
+        case HttpError::InvalidStatusCode: return "Invalid status code";
+        case HttpError::InvalidBody: return "Invalid body";
+        case HttpError::RequestFailed: return "Request failed";
+        case HttpError::InvalidStream: return "Invalid stream";
+    }
+    return "Unknown error";
+}
+
+std::string to_string(StreamError e) {
+    switch (e) {
+        case StreamError::Success: return "Success";
+        case StreamError::Unknown: return "Unknown error";
+        case StreamError::EndOfStream: return "End of stream";
+        case StreamError::StreamNotFound: return "Stream not found";
+        case StreamError::StreamClosed: return "Stream closed";
+        case StreamError::InvalidChunk: return "Invalid chunk";
+        case StreamError::WriteFailed: return "Write failed";
+        case StreamError::ReadFailed: return "Read failed";
+    }
+    return "Unknown error";
+}
+
+std::string to_string(StorageError e) {
+    switch (e) {
+        case StorageError::Success: return "Success";
+        case StorageError::Unknown: return "Unknown error";
+        case StorageError::UnAuthorized: return "Unauthorized";
+        case StorageError::MissingBucketID: return "Missing bucket ID";
+        case StorageError::MissingFileName: return "Missing file name";
+        case StorageError::EmptyContent: return "Empty content";
+        case StorageError::ContentNotFound: return "Content not found";
+        case StorageError::InvalidAttributes: return "Invalid attributes";
+        case StorageError::InternalError: return "Internal error";
+    }
+    return "Unknown error";
+}
+
+std::string to_string(KVError e) {
+    switch (e) {
+        case KVError::Success: return "Success";
+        case KVError::Unknown: return "Unknown error";
+        case KVError::UnAuthorized: return "Unauthorized";
+        case KVError::NotFound: return "Key not found";
+    }
+    return "Unknown error";
+}
+
+HttpStatusCode to_http_status_code(HttpError e) {
+    switch (e) {
+        case HttpError::Success: return 200;
+        case HttpError::UnAuthorized: return 401;
+        case HttpError::MessageTooLarge: return 413;
+        case HttpError::InvalidMethod:
+        case HttpError::InvalidUri:
+        case HttpError::InvalidHeaderName:
+        case HttpError::InvalidHeaderValue:
+        case HttpError::InvalidStatusCode:
+        case HttpError::InvalidBody: return 400;
+        case HttpError::RequestFailed: return 502;
+        case HttpError::Unknown:
+        case HttpError::InvalidStream: return 500;
+    }
+    return 500;
+}
+
+HttpStatusCode to_http_status_code(StorageError e) {
+    switch (e) {
+        case StorageError::Success: return 200;
+        case StorageError::UnAuthorized: return 401;
+        case StorageError::MissingBucketID:
+        case StorageError::MissingFileName:
+        case StorageError::EmptyContent:
+        case StorageError::InvalidAttributes: return 400;
+        case StorageError::ContentNotFound: return 404;
+        case StorageError::Unknown:
+        case StorageError::InternalError: return 500;
+    }
+    return 500;
+}
+
+HttpStatusCode to_http_status_code(KVError e) {
+    switch (e) {
+        case KVError::Success: return 200;
+        case KVError::UnAuthorized: return 401;
+        case KVError::NotFound: return 404;
+        case KVError::Unknown: return 400;
+    }
+    return 500;
+}
+
+} // namespace error
+} // namespace edjx
@@ -0,0 +1,201 @@
+#include <cstdio>
+#include <memory>
+#include <sys/stat.h>
+
+#include <edjx/fetch.hpp>
+
+#include "sim.hpp"
+
+using edjx::error::HttpError;
+using edjx::error::StreamError;
+using edjx::http::HttpMethod;
+using edjx::http::HttpHeaders;
+using edjx::http::HttpStatusCode;
+using edjx::http::Uri;
+using edjx::stream::ReadStream;
+using edjx::stream::WriteStream;
+
+namespace edjx {
+namespace fetch {
+
+namespace detail {
+
+struct PendingFetch {
+    Uri uri;
+    HttpMethod method;
+    HttpHeaders headers;
+    std::shared_ptr<edjx::sim::BufferSink> body;
+};
+
+} // namespace detail
+
+static std::string json_escape(const std::string & str) {
+    std::string escaped;
+    for (unsigned char c : str) {
+        switch (c) {
+            case '"': escaped += "\\\""; break;
+            case '\\': escaped += "\\\\"; break;
+            case '\n': escaped += "\\n"; break;
+            case '\r': escaped += "\\r"; break;
+            case '\t': escaped += "\\t"; break;
+            default:
+                if (c < 0x20) {
+                    char buf[8];
+                    snprintf(buf, sizeof(buf), "\\u%04x", c);
+                    escaped += buf;
+                } else {
+                    escaped += static_cast<char>(c);
+                }
+                break;
+        }
+    }
+    return escaped;
+}
+
+static std::string content_type_of(const std::string & path) {
+    size_t dot = path.rfind('.');
+    std::string extension = dot == std::string::npos ? "" : path.substr(dot + 1);
+    if (extension == "txt") return "text/plain";
+    if (extension == "html") return "text/html";
+    if (extension == "json") return "application/json";
+    return "application/octet-stream";
+}
+
+// Loopback origin. A GET of https://host/path is served from
+// $EDJX_SIM_ORIGIN_DIR/host/path if that file exists; every other request
+// is answered with an httpbin-style JSON echo of the request.
+static void serve(
+    const Uri & uri,
+    HttpMethod method,
+    const HttpHeaders & headers,
+    const std::vector<uint8_t> & body,
+    HttpStatusCode & status,
+    HttpHeaders & response_headers,
+    ReadStream & response_body
+) {
+    const std::string & url = uri.as_string();
+    size_t scheme_end = url.find("://");
+    size_t host_begin = scheme_end == std::string::npos ? 0 : scheme_end + 3;
+    size_t path_begin = url.find('/', host_begin);
+    std::string host = url.substr(host_begin, path_begin - host_begin);
+    std::string path = path_begin == std::string::npos ? "/" : url.substr(path_begin);
+    path = path.substr(0, path.find('?'));
+
+    response_headers.clear();
+
+    std::string origin_dir = edjx::sim::env("EDJX_SIM_ORIGIN_DIR", "");
+    if (method == HttpMethod::GET && !origin_dir.empty() && path.find("..") == std::string::npos) {
+        std::string file_path = origin_dir + "/" + host + path;
+        struct stat st;
+        if (stat(file_path.c_str(), &st) == 0 && S_ISREG(st.st_mode)) {
+            FILE * file = fopen(file_path.c_str(), "rb");
+            if (file != nullptr) {
+                status = 200;
+                response_headers["content-type"] = {content_type_of(file_path)};
+                response_headers["content-length"] = {std::to_string(st.st_size)};
+                response_body = ReadStream(std::make_shared<edjx::sim::FileSource>(file, true, -1));
+                return;
+            }
+        }
+    }
+
+    std::string echo = "{\"method\":\"" + edjx::http::to_string(method)
+        + "\",\"url\":\"" + json_escape(url) + "\",\"headers\":{";
+    bool first_header = true;
+    for (const auto & header : headers) {
+        std::string joined;
+        for (const std::string & value : header.second) {
+            joined += (joined.empty() ? "" : ",") + value;
+        }
+        echo += (first_header ? "\"" : ",\"") + json_escape(header.first) + "\":\"" + json_escape(joined) + "\"";
+        first_header = false;
+    }
+    echo += "},\"data\":\"" + json_escape(std::string(body.begin(), body.end())) + "\"}\n";
+
+    status = 200;
+    response_headers["content-type"] = {"application/json"};
+    response_headers["content-length"] = {std::to_string(echo.size())};
+    response_body = ReadStream(std::make_shared<edjx::sim::BufferSource>(
+        std::vector<uint8_t>(echo.begin(), echo.end())
+    ));
+}
+
+FetchResponse::FetchResponse() : status(0) {}
+
+HttpStatusCode FetchResponse::get_status_code() const {
+    return status;
+}
+
+const HttpHeaders & FetchResponse::get_headers() const {
+    return headers;
+}
+
+StreamError FetchResponse::read_body(std::vector<uint8_t> & result) {
+    StreamError err = read_stream.read_all(result);
+    read_stream.close();
+    return err;
+}
+
+ReadStream FetchResponse::get_read_stream() {
+    return read_stream;
+}
+
+FetchResponsePending::FetchResponsePending() {}
+
+HttpError FetchResponsePending::get_fetch_response(FetchResponse & result) {
+    if (!pending) {
+        return HttpError::InvalidStream;
+    }
+    if (!pending->body->is_closed()) {
+        // The request body stream has to be closed before a response arrives
+        return HttpError::RequestFailed;
+    }
+    serve(pending->uri, pending->method, pending->headers, pending->body->get_data(),
+        result.status, result.headers, result.read_stream);
+    pending.reset();
+    return HttpError::Success;
+}
+
+HttpFetch::HttpFetch(const Uri & uri, HttpMethod method) : uri(uri), method(method) {}
+
+HttpFetch & HttpFetch::set_header(const std::string & name, const std::string & value) {
+    headers[edjx::sim::to_lower(name)] = {value};
+    return *this;
+}
+
+HttpFetch & HttpFetch::append_header(const std::string & name, const std::string & value) {
+    headers[edjx::sim::to_lower(name)].push_back(value);
+    return *this;
+}
+
+HttpFetch & HttpFetch::set_body(const std::vector<uint8_t> & body) {
+    this->body = body;
+    return *this;
+}
+
+HttpError HttpFetch::send(FetchResponse & result) {
+    if (uri.as_string().empty()) {
+        return HttpError::InvalidUri;
+    }
+    if (method == HttpMethod::NONE) {
+        return HttpError::InvalidMethod;
+    }
+    serve(uri, method, headers, body, result.status, result.headers, result.read_stream);
+    return HttpError::Success;
+}
+
+HttpError HttpFetch::send_streaming(FetchResponsePending & result, WriteStream & write_stream) {
+    if (uri.as_string().empty()) {
+        return HttpError::InvalidUri;
+    }
+    if (method == HttpMethod::NONE) {
+        return HttpError::InvalidMethod;
+    }
+    std::shared_ptr<edjx::sim::BufferSink> sink = std::make_shared<edjx::sim::BufferSink>();
+    result.pending = std::make_shared<detail::PendingFetch>(detail::PendingFetch{uri, method, headers, sink});
+    write_stream = WriteStream(sink);
+    return HttpError::Success;
+}
+
+} // namespace fetch
+} // namespace edjx
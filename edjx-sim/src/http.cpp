@@ -0,0 +1,47 @@
+#include <edjx/http.hpp>
+
+namespace edjx {
+namespace http {
+
+Uri::Uri() {}
+
+Uri::Uri(const std::string & uri) : uri(uri) {}
+
+Uri::Uri(const char * uri) : uri(uri) {}
+
+const std::string & Uri::as_string() const {
+    return uri;
+}
+
+std::string to_string(HttpMethod method) {
+    switch (method) {
+        case HttpMethod::NONE: return "";
+        case HttpMethod::GET: return "GET";
+        case HttpMethod::HEAD: return "HEAD";
+        case HttpMethod::POST: return "POST";
+        case HttpMethod::PUT: return "PUT";
+        case HttpMethod::DELETE: return "DELETE";
+        case HttpMethod::CONNECT: return "CONNECT";
+        case HttpMethod::OPTIONS: return "OPTIONS";
+        case HttpMethod::TRACE: return "TRACE";
+        case HttpMethod::PATCH: return "PATCH";
+    }
+    return "";
+}
+
+HttpMethod method_from_string(const std::string & method) {
+    static const HttpMethod methods[] = {
+        HttpMethod::GET, HttpMethod::HEAD, HttpMethod::POST, HttpMethod::PUT,
+        HttpMethod::DELETE, HttpMethod::CONNECT, HttpMethod::OPTIONS,
+        HttpMethod::TRACE, HttpMethod::PATCH
+    };
+    for (HttpMethod m : methods) {
+        if (to_string(m) == method) {
+            return m;
+        }
+    }
+    return HttpMethod::NONE;
+}
+
+} // namespace http
+} // namespace edjx
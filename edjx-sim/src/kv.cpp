@@ -0,0 +1,126 @@
+#include <cstdio>
+#include <cstdlib>
+#include <chrono>
+#include <map>
+
+#include <edjx/kv.hpp>
+
+#include "sim.hpp"
+
+using edjx::error::KVError;
+
+namespace edjx {
+namespace kv {
+
+struct Entry {
+    std::vector<uint8_t> value;
+    uint64_t expires_at; // Milliseconds since epoch, 0 = no expiry
+};
+
+static uint64_t now_ms() {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+static std::string hex_encode(const std::string & str) {
+    static const char digits[] = "0123456789abcdef";
+    std::string hex;
+    for (unsigned char c : str) {
+        hex += digits[c >> 4];
+        hex += digits[c & 0xf];
+    }
+    return hex;
+}
+
+static std::string hex_decode(const std::string & hex) {
+    std::string str;
+    for (size_t i = 0; i + 1 < hex.size(); i += 2) {
+        str += static_cast<char>(strtoul(hex.substr(i, 2).c_str(), nullptr, 16));
+    }
+    return str;
+}
+
+// $EDJX_SIM_KV_FILE holds one "<hex key> <expiry> <hex value>" line per entry
+static std::map<std::string, Entry> & store() {
+    static std::map<std::string, Entry> entries;
+    static bool loaded = false;
+    if (!loaded) {
+        loaded = true;
+        std::string path = edjx::sim::env("EDJX_SIM_KV_FILE", "");
+        FILE * file = path.empty() ? nullptr : fopen(path.c_str(), "rb");
+        if (file != nullptr) {
+            char key[4096];
+            unsigned long long expires_at;
+            std::string value;
+            while (fscanf(file, "%4095s %llu ", key, &expires_at) == 2) {
+                value.clear();
+                int c;
+                while ((c = fgetc(file)) != EOF && c != '\n') {
+                    value += static_cast<char>(c);
+                }
+                std::string decoded = hex_decode(value);
+                entries[hex_decode(key)] = Entry{
+                    std::vector<uint8_t>(decoded.begin(), decoded.end()), expires_at
+                };
+            }
+            fclose(file);
+        }
+    }
+    return entries;
+}
+
+static void persist() {
+    std::string path = edjx::sim::env("EDJX_SIM_KV_FILE", "");
+    if (path.empty()) {
+        return;
+    }
+    FILE * file = fopen(path.c_str(), "wb");
+    if (file == nullptr) {
+        return;
+    }
+    for (const auto & entry : store()) {
+        fprintf(file, "%s %llu %s\n",
+            hex_encode(entry.first).c_str(),
+            static_cast<unsigned long long>(entry.second.expires_at),
+            hex_encode(std::string(entry.second.value.begin(), entry.second.value.end())).c_str());
+    }
+    fclose(file);
+}
+
+KVError get(std::vector<uint8_t> & result, const std::string & key) {
+    std::map<std::string, Entry> & entries = store();
+    auto it = entries.find(key);
+    if (it == entries.end()) {
+        return KVError::NotFound;
+    }
+    if (it->second.expires_at != 0 && it->second.expires_at <= now_ms()) {
+        entries.erase(it);
+        return KVError::NotFound;
+    }
+    result = it->second.value;
+    return KVError::Success;
+}
+
+KVError put(const std::string & key, const std::string & value, std::optional<uint64_t> ttl) {
+    return put(key, std::vector<uint8_t>(value.begin(), value.end()), ttl);
+}
+
+KVError put(const std::string & key, const std::vector<uint8_t> & value, std::optional<uint64_t> ttl) {
+    if (key.empty()) {
+        return KVError::Unknown;
+    }
+    store()[key] = Entry{value, ttl.has_value() ? now_ms() + ttl.value() : 0};
+    persist();
+    return KVError::Success;
+}
+
+KVError remove(const std::string & key) {
+    if (store().erase(key) == 0) {
+        return KVError::NotFound;
+    }
+    persist();
+    return KVError::Success;
+}
+
+} // namespace kv
+} // namespace edjx
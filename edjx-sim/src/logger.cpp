@@ -0,0 +1,37 @@
+#include <cstdio>
+
+#include <edjx/logger.hpp>
+
+namespace edjx {
+namespace logger {
+
+static void log(const char * level, const std::string & message) {
+    fprintf(stderr, "[%s] %s\n", level, message.c_str());
+}
+
+void trace(const std::string & message) {
+    log("TRACE", message);
+}
+
+void debug(const std::string & message) {
+    log("DEBUG", message);
+}
+
+void info(const std::string & message) {
+    log("INFO", message);
+}
+
+void warn(const std::string & message) {
+    log("WARN", message);
+}
+
+void error(const std::string & message) {
+    log("ERROR", message);
+}
+
+void fatal(const std::string & message) {
+    log("FATAL", message);
+}
+
+} // namespace logger
+} // namespace edjx
@@ -0,0 +1,176 @@
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+
+#include <edjx/request.hpp>
+
+#include "sim.hpp"
+
+using edjx::error::HttpError;
+using edjx::error::StreamError;
+using edjx::http::HttpMethod;
+using edjx::http::HttpHeaders;
+using edjx::http::Uri;
+using edjx::stream::ReadStream;
+
+namespace edjx {
+namespace request {
+
+// Reads a single CRLF (or LF) terminated line from `in` without the terminator
+static bool read_line(FILE * in, std::string & line) {
+    line.clear();
+    int c;
+    while ((c = fgetc(in)) != EOF) {
+        if (c == '\n') {
+            if (!line.empty() && line.back() == '\r') {
+                line.pop_back();
+            }
+            return true;
+        }
+        line += static_cast<char>(c);
+    }
+    return !line.empty();
+}
+
+static std::string trim(const std::string & str) {
+    size_t begin = str.find_first_not_of(" \t");
+    if (begin == std::string::npos) {
+        return "";
+    }
+    size_t end = str.find_last_not_of(" \t");
+    return str.substr(begin, end - begin + 1);
+}
+
+// Decodes a body sent with "Transfer-Encoding: chunked"
+class ChunkedSource : public edjx::stream::detail::ReadSource {
+public:
+    explicit ChunkedSource(FILE * in) : in(in), finished(false), closed(false) {}
+
+    StreamError read_chunk(std::vector<uint8_t> & chunk) override {
+        if (closed) {
+            return StreamError::StreamClosed;
+        }
+        if (finished) {
+            return StreamError::EndOfStream;
+        }
+        std::string line;
+        if (!read_line(in, line)) {
+            return StreamError::ReadFailed;
+        }
+        size_t size = strtoull(line.c_str(), nullptr, 16);
+        if (size == 0) {
+            // Skip trailers
+            while (read_line(in, line) && !line.empty()) {}
+            finished = true;
+            return StreamError::EndOfStream;
+        }
+        chunk.resize(size);
+        if (fread(chunk.data(), 1, size, in) != size || !read_line(in, line)) {
+            return StreamError::ReadFailed;
+        }
+        return StreamError::Success;
+    }
+
+    StreamError close() override {
+        if (closed) {
+            return StreamError::StreamClosed;
+        }
+        closed = true;
+        return StreamError::Success;
+    }
+
+private:
+    FILE * in;
+    bool finished;
+    bool closed;
+};
+
+HttpRequest::HttpRequest() : method(HttpMethod::NONE), body_consumed(false) {}
+
+HttpError HttpRequest::from_client(HttpRequest & result) {
+    std::string line;
+    if (!read_line(stdin, line)) {
+        return HttpError::Unknown;
+    }
+
+    // Request line, e.g., "GET /path?query HTTP/1.1"
+    size_t method_end = line.find(' ');
+    size_t target_end = line.rfind(' ');
+    if (method_end == std::string::npos || target_end <= method_end) {
+        return HttpError::InvalidUri;
+    }
+    HttpMethod method = edjx::http::method_from_string(line.substr(0, method_end));
+    if (method == HttpMethod::NONE) {
+        return HttpError::InvalidMethod;
+    }
+    std::string target = line.substr(method_end + 1, target_end - method_end - 1);
+
+    HttpHeaders headers;
+    while (read_line(stdin, line) && !line.empty()) {
+        size_t colon = line.find(':');
+        if (colon == std::string::npos || colon == 0) {
+            return HttpError::InvalidHeaderName;
+        }
+        headers[edjx::sim::to_lower(line.substr(0, colon))].push_back(trim(line.substr(colon + 1)));
+    }
+
+    if (target.compare(0, 7, "http://") != 0 && target.compare(0, 8, "https://") != 0) {
+        HttpHeaders::const_iterator host = headers.find("host");
+        target = "https://" + (host != headers.end() ? host->second.front() : "localhost") + target;
+    }
+
+    result.uri = Uri(target);
+    result.method = method;
+    result.headers = std::move(headers);
+    result.body_consumed = false;
+
+    return HttpError::Success;
+}
+
+const Uri & HttpRequest::get_uri() const {
+    return uri;
+}
+
+HttpMethod HttpRequest::get_method() const {
+    return method;
+}
+
+const HttpHeaders & HttpRequest::get_headers() const {
+    return headers;
+}
+
+HttpError HttpRequest::read_body(std::vector<uint8_t> & result) {
+    ReadStream read_stream;
+    HttpError err = open_read_stream(read_stream);
+    if (err != HttpError::Success) {
+        return err;
+    }
+    StreamError read_err = read_stream.read_all(result);
+    read_stream.close();
+    return read_err == StreamError::Success ? HttpError::Success : HttpError::InvalidBody;
+}
+
+HttpError HttpRequest::open_read_stream(ReadStream & result) {
+    if (body_consumed) {
+        return HttpError::InvalidStream;
+    }
+    body_consumed = true;
+
+    HttpHeaders::const_iterator transfer_encoding = headers.find("transfer-encoding");
+    if (transfer_encoding != headers.end()
+        && edjx::sim::to_lower(transfer_encoding->second.back()) == "chunked") {
+        result = ReadStream(std::make_shared<ChunkedSource>(stdin));
+        return HttpError::Success;
+    }
+
+    long long limit = -1;
+    HttpHeaders::const_iterator content_length = headers.find("content-length");
+    if (content_length != headers.end()) {
+        limit = strtoll(content_length->second.front().c_str(), nullptr, 10);
+    }
+    result = ReadStream(std::make_shared<edjx::sim::FileSource>(stdin, false, limit));
+    return HttpError::Success;
+}
+
+} // namespace request
+} // namespace edjx
@@ -0,0 +1,142 @@
+#include <cstdio>
+#include <memory>
+
+#include <edjx/response.hpp>
+#include <edjx/logger.hpp>
+
+#include "sim.hpp"
+
+using edjx::error::HttpError;
+using edjx::error::StreamError;
+using edjx::http::HttpHeaders;
+using edjx::http::HttpStatusCode;
+using edjx::stream::WriteStream;
+
+namespace edjx {
+namespace response {
+
+// Only one response can be sent to the client per invocation
+static bool response_sent = false;
+
+// Sends the response body to the client using chunked transfer encoding
+class ClientSink : public edjx::stream::detail::WriteSink {
+public:
+    ClientSink() : closed(false) {}
+
+    StreamError write_chunk(const uint8_t * data, size_t size) override {
+        if (closed) {
+            return StreamError::StreamClosed;
+        }
+        if (size == 0) {
+            return StreamError::Success;
+        }
+        fprintf(stdout, "%zx\r\n", size);
+        fwrite(data, 1, size, stdout);
+        fputs("\r\n", stdout);
+        return fflush(stdout) == 0 ? StreamError::Success : StreamError::WriteFailed;
+    }
+
+    StreamError close() override {
+        if (closed) {
+            return StreamError::StreamClosed;
+        }
+        closed = true;
+        fputs("0\r\n\r\n", stdout);
+        return fflush(stdout) == 0 ? StreamError::Success : StreamError::WriteFailed;
+    }
+
+    StreamError abort() override {
+        if (closed) {
+            return StreamError::StreamClosed;
+        }
+        closed = true;
+        // The terminating chunk is not sent, so the client sees a truncated body
+        edjx::logger::warn("edjx-sim: response stream aborted");
+        fflush(stdout);
+        return StreamError::Success;
+    }
+
+private:
+    bool closed;
+};
+
+HttpResponse::HttpResponse() : status(200) {}
+
+HttpResponse::HttpResponse(const std::string & text) : status(200), body(text.begin(), text.end()) {}
+
+HttpResponse::HttpResponse(const char * text) : HttpResponse(std::string(text)) {}
+
+HttpResponse::HttpResponse(const std::vector<uint8_t> & data) : status(200), body(data) {}
+
+HttpResponse & HttpResponse::set_status(HttpStatusCode status) {
+    this->status = status;
+    return *this;
+}
+
+HttpStatusCode HttpResponse::get_status() const {
+    return status;
+}
+
+HttpResponse & HttpResponse::set_header(const std::string & name, const std::string & value) {
+    headers[edjx::sim::to_lower(name)] = {value};
+    return *this;
+}
+
+HttpResponse & HttpResponse::set_header(const std::string & name, const std::vector<std::string> & values) {
+    headers[edjx::sim::to_lower(name)] = values;
+    return *this;
+}
+
+HttpResponse & HttpResponse::append_header(const std::string & name, const std::string & value) {
+    headers[edjx::sim::to_lower(name)].push_back(value);
+    return *this;
+}
+
+HttpResponse & HttpResponse::append_header(const std::string & name, const std::vector<std::string> & values) {
+    std::vector<std::string> & existing = headers[edjx::sim::to_lower(name)];
+    existing.insert(existing.end(), values.begin(), values.end());
+    return *this;
+}
+
+HttpResponse & HttpResponse::set_headers(const HttpHeaders & headers) {
+    this->headers.clear();
+    for (const auto & header : headers) {
+        this->headers[edjx::sim::to_lower(header.first)] = header.second;
+    }
+    return *this;
+}
+
+const HttpHeaders & HttpResponse::get_headers() const {
+    return headers;
+}
+
+HttpResponse & HttpResponse::set_body(const std::vector<uint8_t> & data) {
+    body = data;
+    return *this;
+}
+
+HttpError HttpResponse::send() {
+    if (response_sent) {
+        return HttpError::InvalidStream;
+    }
+    response_sent = true;
+    edjx::sim::write_response_head(stdout, status, headers, static_cast<long long>(body.size()));
+    fwrite(body.data(), 1, body.size(), stdout);
+    return fflush(stdout) == 0 ? HttpError::Success : HttpError::Unknown;
+}
+
+HttpError HttpResponse::send_streaming(WriteStream & write_stream) {
+    if (response_sent) {
+        return HttpError::InvalidStream;
+    }
+    response_sent = true;
+    edjx::sim::write_response_head(stdout, status, headers, -1);
+    if (fflush(stdout) != 0) {
+        return HttpError::Unknown;
+    }
+    write_stream = WriteStream(std::make_shared<ClientSink>());
+    return HttpError::Success;
+}
+
+} // namespace response
+} // namespace edjx
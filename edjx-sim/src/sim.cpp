@@ -0,0 +1,193 @@
+#include <cstdlib>
+#include <cctype>
+#include <algorithm>
+
+#include "sim.hpp"
+
+using edjx::error::StreamError;
+using edjx::http::HttpHeaders;
+using edjx::http::HttpStatusCode;
+
+namespace edjx {
+namespace sim {
+
+static const size_t DEFAULT_CHUNK_SIZE = 64 * 1024;
+
+std::string env(const char * name, const std::string & fallback) {
+    const char * value = getenv(name);
+    if (value == nullptr || *value == '\0') {
+        return fallback;
+    }
+    return value;
+}
+
+size_t chunk_size() {
+    static size_t size = 0;
+    if (size == 0) {
+        size = strtoull(env("EDJX_SIM_CHUNK_SIZE", "0").c_str(), nullptr, 10);
+        if (size == 0) {
+            size = DEFAULT_CHUNK_SIZE;
+        }
+    }
+    return size;
+}
+
+std::string to_lower(const std::string & str) {
+    std::string result = str;
+    std::transform(result.begin(), result.end(), result.begin(),
+        [](unsigned char c) { return static_cast<char>(tolower(c)); });
+    return result;
+}
+
+std::string reason_phrase(HttpStatusCode status) {
+    switch (status) {
+        case 200: return "OK";
+        case 201: return "Created";
+        case 204: return "No Content";
+        case 206: return "Partial Content";
+        case 304: return "Not Modified";
+        case 400: return "Bad Request";
+        case 401: return "Unauthorized";
+        case 403: return "Forbidden";
+        case 404: return "Not Found";
+        case 405: return "Method Not Allowed";
+        case 413: return "Payload Too Large";
+        case 415: return "Unsupported Media Type";
+        case 416: return "Range Not Satisfiable";
+        case 500: return "Internal Server Error";
+        case 502: return "Bad Gateway";
+        default: return "Unknown";
+    }
+}
+
+void write_response_head(
+    FILE * out,
+    HttpStatusCode status,
+    const HttpHeaders & headers,
+    long long content_length
+) {
+    fprintf(out, "HTTP/1.1 %u %s\r\n", status, reason_phrase(status).c_str());
+    for (const auto & header : headers) {
+        if (header.first == "content-length" || header.first == "transfer-encoding") {
+            continue;
+        }
+        for (const std::string & value : header.second) {
+            fprintf(out, "%s: %s\r\n", header.first.c_str(), value.c_str());
+        }
+    }
+    if (content_length < 0) {
+        fputs("transfer-encoding: chunked\r\n", out);
+    } else {
+        fprintf(out, "content-length: %lld\r\n", content_length);
+    }
+    fputs("\r\n", out);
+}
+
+BufferSource::BufferSource(std::vector<uint8_t> data)
+    : data(std::move(data)), offset(0), closed(false) {}
+
+StreamError BufferSource::read_chunk(std::vector<uint8_t> & chunk) {
+    if (closed) {
+        return StreamError::StreamClosed;
+    }
+    if (offset >= data.size()) {
+        return StreamError::EndOfStream;
+    }
+    size_t size = std::min(chunk_size(), data.size() - offset);
+    chunk.assign(data.begin() + offset, data.begin() + offset + size);
+    offset += size;
+    return StreamError::Success;
+}
+
+StreamError BufferSource::close() {
+    if (closed) {
+        return StreamError::StreamClosed;
+    }
+    closed = true;
+    return StreamError::Success;
+}
+
+FileSource::FileSource(FILE * file, bool owned, long long limit)
+    : file(file), owned(owned), remaining(limit) {}
+
+FileSource::~FileSource() {
+    if (file != nullptr && owned) {
+        fclose(file);
+    }
+}
+
+StreamError FileSource::read_chunk(std::vector<uint8_t> & chunk) {
+    if (file == nullptr) {
+        return StreamError::StreamClosed;
+    }
+    size_t size = chunk_size();
+    if (remaining >= 0) {
+        if (remaining == 0) {
+            return StreamError::EndOfStream;
+        }
+        size = std::min(size, static_cast<size_t>(remaining));
+    }
+    chunk.resize(size);
+    size_t read = fread(chunk.data(), 1, size, file);
+    chunk.resize(read);
+    if (read == 0) {
+        return ferror(file) ? StreamError::ReadFailed : StreamError::EndOfStream;
+    }
+    if (remaining >= 0) {
+        remaining -= static_cast<long long>(read);
+    }
+    return StreamError::Success;
+}
+
+StreamError FileSource::close() {
+    if (file == nullptr) {
+        return StreamError::StreamClosed;
+    }
+    if (owned) {
+        fclose(file);
+    }
+    file = nullptr;
+    return StreamError::Success;
+}
+
+BufferSink::BufferSink() : closed(false), aborted(false) {}
+
+StreamError BufferSink::write_chunk(const uint8_t * chunk, size_t size) {
+    if (closed || aborted) {
+        return StreamError::StreamClosed;
+    }
+    data.insert(data.end(), chunk, chunk + size);
+    return StreamError::Success;
+}
+
+StreamError BufferSink::close() {
+    if (closed || aborted) {
+        return StreamError::StreamClosed;
+    }
+    closed = true;
+    return StreamError::Success;
+}
+
+StreamError BufferSink::abort() {
+    if (closed || aborted) {
+        return StreamError::StreamClosed;
+    }
+    aborted = true;
+    data.clear();
+    return StreamError::Success;
+}
+
+bool BufferSink::is_closed() const {
+    return closed;
+}
+
+bool BufferSink::is_aborted() const {
+    return aborted;
+}
+
+std::vector<uint8_t> & BufferSink::get_data() {
+    return data;
+}
+
+} // namespace sim
+} // namespace edjx
@@ -0,0 +1,88 @@
+#ifndef EDJX_SIM_SIM_HPP
+#define EDJX_SIM_SIM_HPP
+
+#include <cstdint>
+#include <cstddef>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include <edjx/error.hpp>
+#include <edjx/http.hpp>
+#include <edjx/stream.hpp>
+
+// Internal helpers shared by the edjx-sim translation units.
+
+namespace edjx {
+namespace sim {
+
+// Returns the value of an environment variable or `fallback` if it is not set
+std::string env(const char * name, const std::string & fallback);
+
+// Size of chunks returned by read streams ($EDJX_SIM_CHUNK_SIZE, default 64 KiB)
+size_t chunk_size();
+
+std::string to_lower(const std::string & str);
+std::string reason_phrase(edjx::http::HttpStatusCode status);
+
+// Writes the status line and headers of an HTTP/1.1 response. If
+// `content_length` is negative, the body is announced as chunked.
+void write_response_head(
+    FILE * out,
+    edjx::http::HttpStatusCode status,
+    const edjx::http::HttpHeaders & headers,
+    long long content_length
+);
+
+// Read source over an in-memory buffer
+class BufferSource : public edjx::stream::detail::ReadSource {
+public:
+    explicit BufferSource(std::vector<uint8_t> data);
+
+    edjx::error::StreamError read_chunk(std::vector<uint8_t> & chunk) override;
+    edjx::error::StreamError close() override;
+
+private:
+    std::vector<uint8_t> data;
+    size_t offset;
+    bool closed;
+};
+
+// Read source over a file; `limit` < 0 reads until EOF
+class FileSource : public edjx::stream::detail::ReadSource {
+public:
+    FileSource(FILE * file, bool owned, long long limit);
+    ~FileSource() override;
+
+    edjx::error::StreamError read_chunk(std::vector<uint8_t> & chunk) override;
+    edjx::error::StreamError close() override;
+
+private:
+    FILE * file;
+    bool owned;
+    long long remaining;
+};
+
+// Write sink that collects chunks in memory
+class BufferSink : public edjx::stream::detail::WriteSink {
+public:
+    BufferSink();
+
+    edjx::error::StreamError write_chunk(const uint8_t * data, size_t size) override;
+    edjx::error::StreamError close() override;
+    edjx::error::StreamError abort() override;
+
+    bool is_closed() const;
+    bool is_aborted() const;
+    std::vector<uint8_t> & get_data();
+
+private:
+    std::vector<uint8_t> data;
+    bool closed;
+    bool aborted;
+};
+
+} // namespace sim
+} // namespace edjx
+
+#endif // EDJX_SIM_SIM_HPP
@@ -0,0 +1,419 @@
+#include <cstdio>
+#include <cerrno>
+#include <chrono>
+#include <memory>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <edjx/storage.hpp>
+
+#include "sim.hpp"
+
+using edjx::error::StorageError;
+using edjx::error::StreamError;
+using edjx::http::HttpHeaders;
+using edjx::http::HttpStatusCode;
+using edjx::stream::ReadStream;
+using edjx::stream::WriteStream;
+
+namespace edjx {
+namespace storage {
+
+// Object contents are stored in $EDJX_SIM_STORAGE_DIR/objects/<bucket>/<file>
+// and attributes in $EDJX_SIM_STORAGE_DIR/attributes/<bucket>/<file>.
+static std::string storage_dir() {
+    return edjx::sim::env("EDJX_SIM_STORAGE_DIR", "edjx-sim-storage");
+}
+
+static std::string object_path(const std::string & bucket_id, const std::string & file_name) {
+    return storage_dir() + "/objects/" + bucket_id + "/" + file_name;
+}
+
+static std::string attributes_path(const std::string & bucket_id, const std::string & file_name) {
+    return storage_dir() + "/attributes/" + bucket_id + "/" + file_name;
+}
+
+static StorageError validate(const std::string & bucket_id, const std::string & file_name) {
+    if (bucket_id.empty() || bucket_id.find('/') != std::string::npos || bucket_id == "." || bucket_id == "..") {
+        return StorageError::MissingBucketID;
+    }
+    if (file_name.empty() || file_name.front() == '/'
+        || ("/" + file_name + "/").find("/../") != std::string::npos) {
+        return StorageError::MissingFileName;
+    }
+    return StorageError::Success;
+}
+
+// Creates all parent directories of `path`
+static bool make_parent_dirs(const std::string & path) {
+    for (size_t slash = path.find('/', 1); slash != std::string::npos; slash = path.find('/', slash + 1)) {
+        if (mkdir(path.substr(0, slash).c_str(), 0755) != 0 && errno != EEXIST) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool object_exists(const std::string & path) {
+    struct stat st;
+    return stat(path.c_str(), &st) == 0 && S_ISREG(st.st_mode);
+}
+
+static std::string escape_field(const std::string & str) {
+    std::string escaped;
+    for (char c : str) {
+        switch (c) {
+            case '\\': escaped += "\\\\"; break;
+            case '\t': escaped += "\\t"; break;
+            case '\n': escaped += "\\n"; break;
+            default: escaped += c; break;
+        }
+    }
+    return escaped;
+}
+
+static std::string unescape_field(const std::string & str) {
+    std::string result;
+    for (size_t i = 0; i < str.size(); i++) {
+        if (str[i] == '\\' && i + 1 < str.size()) {
+            char c = str[++i];
+            result += c == 't' ? '\t' : (c == 'n' ? '\n' : c);
+        } else {
+            result += str[i];
+        }
+    }
+    return result;
+}
+
+static bool write_attributes(const std::string & path, const FileAttributes & attributes) {
+    if (!make_parent_dirs(path)) {
+        return false;
+    }
+    FILE * file = fopen(path.c_str(), "wb");
+    if (file == nullptr) {
+        return false;
+    }
+    if (attributes.properties_present) {
+        fputs("properties\n", file);
+        for (const auto & property : attributes.properties) {
+            fprintf(file, "property\t%s\t%s\n",
+                escape_field(property.first).c_str(), escape_field(property.second).c_str());
+        }
+    }
+    if (attributes.default_version_present) {
+        fprintf(file, "default_version\t%s\n", escape_field(attributes.default_version).c_str());
+    }
+    return fclose(file) == 0;
+}
+
+static FileAttributes read_attributes(const std::string & path) {
+    FileAttributes attributes = {false, {}, false, ""};
+    FILE * file = fopen(path.c_str(), "rb");
+    if (file == nullptr) {
+        return attributes;
+    }
+    std::string line;
+    int c;
+    while ((c = fgetc(file)) != EOF) {
+        if (c != '\n') {
+            line += static_cast<char>(c);
+            continue;
+        }
+        size_t tab = line.find('\t');
+        std::string kind = line.substr(0, tab);
+        if (kind == "properties") {
+            attributes.properties_present = true;
+        } else if (kind == "property" && tab != std::string::npos) {
+            size_t value_tab = line.find('\t', tab + 1);
+            if (value_tab != std::string::npos) {
+                attributes.properties[unescape_field(line.substr(tab + 1, value_tab - tab - 1))] =
+                    unescape_field(line.substr(value_tab + 1));
+            }
+        } else if (kind == "default_version" && tab != std::string::npos) {
+            attributes.default_version_present = true;
+            attributes.default_version = unescape_field(line.substr(tab + 1));
+        }
+        line.clear();
+    }
+    fclose(file);
+    return attributes;
+}
+
+// Parses properties in the "key1=value1,key2=value2" format
+static FileAttributes attributes_from_properties(const std::string & properties) {
+    FileAttributes attributes = {!properties.empty(), {}, true, ""};
+    size_t begin = 0;
+    while (begin < properties.size()) {
+        size_t end = properties.find(',', begin);
+        if (end == std::string::npos) {
+            end = properties.size();
+        }
+        std::string property = properties.substr(begin, end - begin);
+        size_t eq = property.find('=');
+        if (!property.empty()) {
+            attributes.properties[property.substr(0, eq)] =
+                eq == std::string::npos ? "" : property.substr(eq + 1);
+        }
+        begin = end + 1;
+    }
+
+    // Every upload creates a new version
+    static uint64_t counter = 0;
+    uint64_t now = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+    char version[32];
+    snprintf(version, sizeof(version), "%016llx", static_cast<unsigned long long>(now + counter++));
+    attributes.default_version = version;
+
+    return attributes;
+}
+
+namespace detail {
+
+struct PendingPut {
+    std::string bucket_id;
+    std::string file_name;
+    FileAttributes attributes;
+    bool closed;
+    bool committed;
+};
+
+} // namespace detail
+
+struct Access {
+    static void set(StorageResponse & response, HttpStatusCode status, HttpHeaders headers, ReadStream body) {
+        response.status = status;
+        response.headers = std::move(headers);
+        response.read_stream = body;
+    }
+
+    static void set_pending(StorageResponsePending & pending, std::shared_ptr<detail::PendingPut> put) {
+        pending.pending = std::move(put);
+    }
+
+    static std::shared_ptr<detail::PendingPut> & get_pending(StorageResponsePending & pending) {
+        return pending.pending;
+    }
+};
+
+static void set_empty_response(StorageResponse & response) {
+    Access::set(response, 200, {}, ReadStream(std::make_shared<edjx::sim::BufferSource>(std::vector<uint8_t>())));
+}
+
+// Uploads into a temporary file that replaces the object on close()
+class PutSink : public edjx::stream::detail::WriteSink {
+public:
+    PutSink(FILE * file, std::string temp_path, std::shared_ptr<detail::PendingPut> put)
+        : file(file), temp_path(std::move(temp_path)), put(std::move(put)) {}
+
+    ~PutSink() override {
+        if (file != nullptr) {
+            abort();
+        }
+    }
+
+    StreamError write_chunk(const uint8_t * data, size_t size) override {
+        if (file == nullptr) {
+            return StreamError::StreamClosed;
+        }
+        return fwrite(data, 1, size, file) == size ? StreamError::Success : StreamError::WriteFailed;
+    }
+
+    StreamError close() override {
+        if (file == nullptr) {
+            return StreamError::StreamClosed;
+        }
+        bool ok = fclose(file) == 0;
+        file = nullptr;
+        put->closed = true;
+        std::string path = object_path(put->bucket_id, put->file_name);
+        ok = ok && rename(temp_path.c_str(), path.c_str()) == 0
+            && write_attributes(attributes_path(put->bucket_id, put->file_name), put->attributes);
+        put->committed = ok;
+        return ok ? StreamError::Success : StreamError::WriteFailed;
+    }
+
+    StreamError abort() override {
+        if (file == nullptr) {
+            return StreamError::StreamClosed;
+        }
+        fclose(file);
+        file = nullptr;
+        unlink(temp_path.c_str());
+        put->closed = true;
+        return StreamError::Success;
+    }
+
+private:
+    FILE * file;
+    std::string temp_path;
+    std::shared_ptr<detail::PendingPut> put;
+};
+
+StorageResponse::StorageResponse() : status(0) {}
+
+HttpStatusCode StorageResponse::get_status_code() const {
+    return status;
+}
+
+const HttpHeaders & StorageResponse::get_headers() const {
+    return headers;
+}
+
+StreamError StorageResponse::read_body(std::vector<uint8_t> & result) {
+    StreamError err = read_stream.read_all(result);
+    read_stream.close();
+    return err;
+}
+
+ReadStream StorageResponse::get_read_stream() {
+    return read_stream;
+}
+
+StorageResponsePending::StorageResponsePending() {}
+
+StorageError StorageResponsePending::get_storage_response(StorageResponse & result) {
+    if (!pending || !pending->closed) {
+        return StorageError::InternalError;
+    }
+    bool committed = pending->committed;
+    pending.reset();
+    if (!committed) {
+        return StorageError::InternalError;
+    }
+    set_empty_response(result);
+    return StorageError::Success;
+}
+
+StorageError get(StorageResponse & result, const std::string & bucket_id, const std::string & file_name) {
+    StorageError err = validate(bucket_id, file_name);
+    if (err != StorageError::Success) {
+        return err;
+    }
+    std::string path = object_path(bucket_id, file_name);
+    struct stat st;
+    if (stat(path.c_str(), &st) != 0 || !S_ISREG(st.st_mode)) {
+        return StorageError::ContentNotFound;
+    }
+    FILE * file = fopen(path.c_str(), "rb");
+    if (file == nullptr) {
+        return StorageError::InternalError;
+    }
+
+    HttpHeaders headers;
+    headers["content-length"] = {std::to_string(st.st_size)};
+    FileAttributes attributes = read_attributes(attributes_path(bucket_id, file_name));
+    for (const auto & property : attributes.properties) {
+        std::string name = edjx::sim::to_lower(property.first);
+        if (name == "content-type" || name == "cache-control") {
+            headers[name] = {property.second};
+        }
+    }
+
+    Access::set(result, 200, std::move(headers), ReadStream(std::make_shared<edjx::sim::FileSource>(file, true, -1)));
+    return StorageError::Success;
+}
+
+StorageError put(
+    StorageResponse & result,
+    const std::string & bucket_id,
+    const std::string & file_name,
+    const std::string & properties,
+    const std::vector<uint8_t> & contents
+) {
+    StorageResponsePending pending;
+    WriteStream write_stream;
+    StorageError err = put_streaming(pending, write_stream, bucket_id, file_name, properties);
+    if (err != StorageError::Success) {
+        return err;
+    }
+    if (write_stream.write_chunk(contents) != StreamError::Success) {
+        write_stream.abort();
+        return StorageError::InternalError;
+    }
+    write_stream.close();
+    return pending.get_storage_response(result);
+}
+
+StorageError put_streaming(
+    StorageResponsePending & result,
+    WriteStream & write_stream,
+    const std::string & bucket_id,
+    const std::string & file_name,
+    const std::string & properties
+) {
+    StorageError err = validate(bucket_id, file_name);
+    if (err != StorageError::Success) {
+        return err;
+    }
+    std::string path = object_path(bucket_id, file_name);
+    static unsigned temp_counter = 0;
+    std::string temp_path = path + ".edjx-sim-upload-" + std::to_string(temp_counter++);
+    if (!make_parent_dirs(path)) {
+        return StorageError::InternalError;
+    }
+    FILE * file = fopen(temp_path.c_str(), "wb");
+    if (file == nullptr) {
+        return StorageError::InternalError;
+    }
+
+    std::shared_ptr<detail::PendingPut> put = std::make_shared<detail::PendingPut>(
+        detail::PendingPut{bucket_id, file_name, attributes_from_properties(properties), false, false}
+    );
+    Access::set_pending(result, put);
+    write_stream = WriteStream(std::make_shared<PutSink>(file, temp_path, put));
+    return StorageError::Success;
+}
+
+StorageError remove(StorageResponse & result, const std::string & bucket_id, const std::string & file_name) {
+    StorageError err = validate(bucket_id, file_name);
+    if (err != StorageError::Success) {
+        return err;
+    }
+    if (unlink(object_path(bucket_id, file_name).c_str()) != 0) {
+        return StorageError::ContentNotFound;
+    }
+    unlink(attributes_path(bucket_id, file_name).c_str());
+    set_empty_response(result);
+    return StorageError::Success;
+}
+
+StorageError get_attributes(FileAttributes & result, const std::string & bucket_id, const std::string & file_name) {
+    StorageError err = validate(bucket_id, file_name);
+    if (err != StorageError::Success) {
+        return err;
+    }
+    if (!object_exists(object_path(bucket_id, file_name))) {
+        return StorageError::ContentNotFound;
+    }
+    result = read_attributes(attributes_path(bucket_id, file_name));
+    return StorageError::Success;
+}
+
+StorageError set_attributes(
+    StorageResponse & result,
+    const std::string & bucket_id,
+    const std::string & file_name,
+    const FileAttributes & attributes
+) {
+    StorageError err = validate(bucket_id, file_name);
+    if (err != StorageError::Success) {
+        return err;
+    }
+    if (!object_exists(object_path(bucket_id, file_name))) {
+        return StorageError::ContentNotFound;
+    }
+
+    // The default version is managed by the storage, only properties are replaced
+    FileAttributes updated = read_attributes(attributes_path(bucket_id, file_name));
+    updated.properties_present = attributes.properties_present;
+    updated.properties = attributes.properties;
+    if (!write_attributes(attributes_path(bucket_id, file_name), updated)) {
+        return StorageError::InternalError;
+    }
+    set_empty_response(result);
+    return StorageError::Success;
+}
+
+} // namespace storage
+} // namespace edjx
@@ -0,0 +1,134 @@
+#include <cinttypes>
+#include <cstdio>
+
+#include <edjx/stream.hpp>
+#include <edjx/logger.hpp>
+
+#include "sim.hpp"
+
+using edjx::error::StreamError;
+
+namespace edjx {
+namespace stream {
+
+// Host calls of the stream API. With $EDJX_SIM_STATS set, the counts are
+// logged when the process exits.
+struct HostCallStats {
+    uint64_t read_calls = 0;
+    uint64_t read_bytes = 0;
+    uint64_t write_calls = 0;
+    uint64_t write_bytes = 0;
+
+    ~HostCallStats() {
+        if (edjx::sim::env("EDJX_SIM_STATS", "").empty()) {
+            return;
+        }
+        log("read_chunk", read_calls, read_bytes);
+        log("write_chunk", write_calls, write_bytes);
+    }
+
+    static void log(const char * name, uint64_t calls, uint64_t bytes) {
+        char line[160];
+        snprintf(line, sizeof(line), "edjx-sim: %s: %" PRIu64 " calls, %" PRIu64 " bytes (%.1f bytes/call)",
+            name, calls, bytes, calls == 0 ? 0.0 : static_cast<double>(bytes) / calls);
+        edjx::logger::info(line);
+    }
+};
+
+static HostCallStats stats;
+
+ReadStream::ReadStream() {}
+
+ReadStream::ReadStream(std::shared_ptr<detail::ReadSource> source) : source(std::move(source)) {}
+
+StreamError ReadStream::read_chunk(std::vector<uint8_t> & chunk) {
+    if (!source) {
+        return StreamError::StreamNotFound;
+    }
+    StreamError err = source->read_chunk(chunk);
+    stats.read_calls++;
+    if (err == StreamError::Success) {
+        stats.read_bytes += chunk.size();
+    }
+    return err;
+}
+
+StreamError ReadStream::read_all(std::vector<uint8_t> & data) {
+    data.clear();
+    std::vector<uint8_t> chunk;
+    StreamError err;
+    while ((err = read_chunk(chunk)) == StreamError::Success) {
+        data.insert(data.end(), chunk.begin(), chunk.end());
+    }
+    return err == StreamError::EndOfStream ? StreamError::Success : err;
+}
+
+StreamError ReadStream::pipe_to(WriteStream & write_stream) {
+    std::vector<uint8_t> chunk;
+    StreamError err;
+    while ((err = read_chunk(chunk)) == StreamError::Success) {
+        StreamError write_err = write_stream.write_chunk(chunk);
+        if (write_err != StreamError::Success) {
+            close();
+            write_stream.abort();
+            return write_err;
+        }
+    }
+    if (err != StreamError::EndOfStream) {
+        close();
+        write_stream.abort();
+        return err;
+    }
+    StreamError close_err = close();
+    StreamError write_close_err = write_stream.close();
+    if (close_err != StreamError::Success) {
+        return close_err;
+    }
+    return write_close_err;
+}
+
+StreamError ReadStream::close() {
+    if (!source) {
+        return StreamError::StreamNotFound;
+    }
+    return source->close();
+}
+
+WriteStream::WriteStream() {}
+
+WriteStream::WriteStream(std::shared_ptr<detail::WriteSink> sink) : sink(std::move(sink)) {}
+
+StreamError WriteStream::write_chunk(const std::vector<uint8_t> & data) {
+    if (!sink) {
+        return StreamError::StreamNotFound;
+    }
+    stats.write_calls++;
+    stats.write_bytes += data.size();
+    return sink->write_chunk(data.data(), data.size());
+}
+
+StreamError WriteStream::write_chunk(const std::string & text) {
+    if (!sink) {
+        return StreamError::StreamNotFound;
+    }
+    stats.write_calls++;
+    stats.write_bytes += text.size();
+    return sink->write_chunk(reinterpret_cast<const uint8_t *>(text.data()), text.size());
+}
+
+StreamError WriteStream::close() {
+    if (!sink) {
+        return StreamError::StreamNotFound;
+    }
+    return sink->close();
+}
+
+StreamError WriteStream::abort() {
+    if (!sink) {
+        return StreamError::StreamNotFound;
+    }
+    return sink->abort();
+}
+
+} // namespace stream
+} // namespace edjx
@@ -0,0 +1,15 @@
+#include <edjx/utils.hpp>
+
+namespace edjx {
+namespace utils {
+
+std::string to_string(const std::vector<uint8_t> & bytes) {
+    return std::string(bytes.begin(), bytes.end());
+}
+
+std::vector<uint8_t> to_bytes(const std::string & str) {
+    return std::vector<uint8_t>(str.begin(), str.end());
+}
+
+} // namespace utils
+} // namespace edjx
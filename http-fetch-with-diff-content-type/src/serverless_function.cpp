@@ -11,6 +11,8 @@
 #include <edjx/fetch.hpp>
 #include <edjx/utils.hpp>
 
+#include <edjsamples/query.hpp>
+
 using edjx::logger::info;
 using edjx::logger::error;
 using edjx::error::HttpError;
@@ -22,65 +24,19 @@ using edjx::request::HttpRequest;
 using edjx::response::HttpResponse;
 using edjx::fetch::HttpFetch;
 using edjx::fetch::FetchResponse;
+using edjsamples::query::QueryParams;
 
 static const HttpStatusCode HTTP_STATUS_OK = 200;
 static const HttpStatusCode HTTP_STATUS_BAD_REQUEST = 400;
 
 
-std::optional<std::string> query_param_by_name(const HttpRequest & req, const std::string & param_name) {
-    std::string uri = req.get_uri().as_string();
-    std::vector<std::pair<std::string, std::string>> query_parsed;
-
-    // e.g., https://example.com/path/to/page?name=ferret&color=purple
-
-    size_t query_start = uri.find('?');
-
-    if (query_start != std::string::npos) {
-        // Query is present
-        std::string name;
-        std::string value;
-        bool parsing_name = true;
-        for (std::string::iterator it = uri.begin() + query_start + 1; it != uri.end(); ++it) {
-            char c = *it;
-            switch (c) {
-                case '?':
-                    break; // Invalid URI
-                case '=':
-                    parsing_name = false;
-                    break;
-                case '&':
-                    query_parsed.push_back(make_pair(name, value));
-                    name.clear();
-                    value.clear();
-                    parsing_name = true;
-                    break;
-                default:
-                    if (parsing_name) {
-                        name += c;
-                    } else {
-                        value += c;
-                    }
-                    break;
-            }
-        }
-        if (!name.empty() || !value.empty()) {
-            query_parsed.push_back(make_pair(name, value));
-        }
-
-        for (const auto & parameter : query_parsed) {
-            if (parameter.first == param_name) {
-                return parameter.second;
-            }
-        }
-    }
-
-    return {};
-}
-
 HttpResponse serverless(const HttpRequest & req) {
     info("**HTTP Fetch with diff content type function**");
 
-    std::string body_type = query_param_by_name(req, "body_type")
+    std::string uri = req.get_uri().as_string();
+    QueryParams query(uri);
+
+    std::string body_type = query.get_decoded("body_type")
         .value_or("application/json");
 
     std::vector<uint8_t> body;
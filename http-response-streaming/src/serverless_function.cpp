@@ -8,6 +8,8 @@
 #include <edjx/http.hpp>
 #include <edjx/stream.hpp>
 
+#include <edjsamples/stream.hpp>
+
 using edjx::logger::info;
 using edjx::logger::error;
 using edjx::request::HttpRequest;
@@ -16,6 +18,7 @@ using edjx::http::HttpStatusCode;
 using edjx::stream::WriteStream;
 using edjx::error::HttpError;
 using edjx::error::StreamError;
+using edjsamples::stream::BufferedWriteStream;
 
 static const HttpStatusCode HTTP_STATUS_OK = 200;
 
@@ -42,10 +45,13 @@ bool serverless_streaming(HttpRequest & req) {
     uint32_t iterations = 10000;
     bool success = true;
 
+    // The chunks are coalesced into fewer, larger write_chunk() calls
+    BufferedWriteStream buffered_stream(write_stream);
+
     for (uint32_t i = 0; i < iterations; i++) {
         // Send a chunk
         StreamError err;
-        err = write_stream.write_chunk("Chunk " + std::to_string(i) + "/" + std::to_string(iterations) + "\r\n");
+        err = buffered_stream.write_chunk("Chunk " + std::to_string(i) + "/" + std::to_string(iterations) + "\r\n");
         // Check if the chunk was successfully sent
         if (err != StreamError::Success) {
             error("Error when writing a chunk: " + edjx::error::to_string(err));
@@ -57,14 +63,14 @@ bool serverless_streaming(HttpRequest & req) {
     // Close the stream
     if (success) {
         info("** Closing the write stream **");
-        StreamError close_err = write_stream.close();
+        StreamError close_err = buffered_stream.close();
         if (close_err != StreamError::Success) {
             error("Error when closing the stream: " + to_string(close_err));
             success = false;
         }
     } else {
         info("** Aborting the write stream **");
-        StreamError close_err = write_stream.abort();
+        StreamError close_err = buffered_stream.abort();
         if (close_err != StreamError::Success) {
             error("Error when aborting the stream: " + to_string(close_err));
             success = false;
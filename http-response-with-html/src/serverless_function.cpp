@@ -1,16 +1,21 @@
 #include <cstdint>
 #include <string>
+#include <string_view>
 #include <vector>
+#include <optional>
 
 #include <edjx/logger.hpp>
 #include <edjx/request.hpp>
 #include <edjx/response.hpp>
 #include <edjx/http.hpp>
 
+#include <edjsamples/query.hpp>
+
 using edjx::logger::info;
 using edjx::request::HttpRequest;
 using edjx::response::HttpResponse;
 using edjx::http::HttpStatusCode;
+using edjsamples::query::QueryParams;
 
 static const HttpStatusCode HTTP_STATUS_OK = 200;
 
@@ -105,60 +110,13 @@ EDJX, Inc.<br>8601 Six Forks Road, Suite 400<br>Raleigh, NC 27615\n\
 </body>\n\
 </html>";
 
-std::string query_param_by_name(const HttpRequest & req, const std::string & param_name) {
-    std::string uri = req.get_uri().as_string();
-    std::vector<std::pair<std::string, std::string>> uri_parsed;
-
-    // e.g., https://example.com/path/to/page?name=ferret&color=purple
-
-    size_t query_start = uri.find('?');
-
-    if (query_start != std::string::npos) {
-        // Query is present
-        std::string name;
-        std::string value;
-        bool parsing_name = true;
-        for (std::string::iterator it = uri.begin() + query_start + 1; it != uri.end(); ++it) {
-            char c = *it;
-            switch (c) {
-                case '?':
-                    break; // Invalid URI
-                case '=':
-                    parsing_name = false;
-                    break;
-                case '&':
-                    uri_parsed.push_back(make_pair(name, value));
-                    name.clear();
-                    value.clear();
-                    parsing_name = true;
-                    break;
-                default:
-                    if (parsing_name) {
-                        name += c;
-                    } else {
-                        value += c;
-                    }
-                    break;
-            }
-        }
-        if (!name.empty() || !value.empty()) {
-            uri_parsed.push_back(make_pair(name, value));
-        }
-
-        for (const auto & parameter : uri_parsed) {
-            if (parameter.first == param_name) {
-                return parameter.second;
-            }
-        }
-    }
-
-    return "";
-}
-
 HttpResponse serverless(const HttpRequest & req) {
     info("**HTTP response with HTML function**");
 
-    std::string page = query_param_by_name(req, "page");
+    std::string uri = req.get_uri().as_string();
+    QueryParams query(uri);
+
+    std::string_view page = query.get("page").value_or("");
     if (page.empty()) {
         page = "home";
     }
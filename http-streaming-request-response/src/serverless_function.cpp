@@ -8,6 +8,8 @@
 #include <edjx/http.hpp>
 #include <edjx/stream.hpp>
 
+#include <edjsamples/stream.hpp>
+
 using edjx::logger::info;
 using edjx::logger::error;
 using edjx::request::HttpRequest;
@@ -17,9 +19,14 @@ using edjx::stream::ReadStream;
 using edjx::stream::WriteStream;
 using edjx::error::HttpError;
 using edjx::error::StreamError;
+using edjsamples::stream::CopyStats;
+using edjsamples::stream::ChunkPool;
 
 static const HttpStatusCode HTTP_STATUS_OK = 200;
 
+// Capacity of the chunk buffer, allocated once per request
+static const size_t CHUNK_CAPACITY = 64 * 1024;
+
 bool serverless_streaming(HttpRequest & req) {
     info("** Streamed HTTP request and response **");
 
@@ -57,29 +64,24 @@ bool serverless_streaming(HttpRequest & req) {
     }
 
     // Read all chunks from the read stream and send them to the write stream
-    int count = 0;
-    std::vector<uint8_t> chunk;
-    StreamError read_err;
-    while ((read_err = read_stream.read_chunk(chunk)) == StreamError::Success) {
-        write_err = write_stream.write_chunk(chunk);
-        if (write_err != StreamError::Success) {
-            error("Error when writing a chunk: " + to_string(write_err));
-            read_stream.close();
-            write_stream.abort();
-            return false;
-        }
-        count++;
-    }
-    if (read_err != StreamError::EndOfStream) {
-        error("Error when reading a chunk: " + to_string(read_err));
+    ChunkPool pool(1, CHUNK_CAPACITY);
+    CopyStats stats;
+    StreamError copy_err = edjsamples::stream::copy(read_stream, write_stream, stats, pool);
+    if (copy_err != StreamError::Success) {
+        error("Error when copying a chunk: " + to_string(copy_err));
         read_stream.close();
         write_stream.abort();
         return false;
     }
+    info(
+        "Copied " + std::to_string(stats.chunks) + " chunks, " + std::to_string(stats.bytes) + " bytes; "
+            + "waited " + std::to_string(stats.read_stall.count() / 1000) + " us for reads and "
+            + std::to_string(stats.write_stall.count() / 1000) + " us for writes"
+    );
 
     // Write some statistics at the end
     write_err = write_stream.write_chunk(
-        "\r\nTransmitted " + std::to_string(count) + " chunks.\r\n"
+        "\r\nTransmitted " + std::to_string(stats.chunks) + " chunks.\r\n"
     );
     if (write_err != StreamError::Success) {
         error("Error when writing the summary info: " + to_string(write_err));
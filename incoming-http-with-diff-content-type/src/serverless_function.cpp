@@ -1,194 +1,391 @@
+#include <cstdint>
 #include <string>
+#include <string_view>
 #include <vector>
 #include <map>
 #include <optional>
-#include <algorithm>
 
 #include <edjx/logger.hpp>
 #include <edjx/http.hpp>
 #include <edjx/request.hpp>
 #include <edjx/response.hpp>
+#include <edjx/stream.hpp>
+
+#include <edjsamples/percent.hpp>
+#include <edjsamples/headers.hpp>
+#include <edjsamples/media_type.hpp>
+#include <edjsamples/json.hpp>
 
 using edjx::logger::info;
+using edjx::logger::error;
 using edjx::http::HttpMethod;
 using edjx::http::HttpHeaders;
 using edjx::http::HttpStatusCode;
 using edjx::request::HttpRequest;
 using edjx::response::HttpResponse;
 using edjx::error::HttpError;
+using edjx::error::StreamError;
+using edjx::stream::ReadStream;
+using edjx::stream::WriteStream;
+using edjsamples::headers::HeaderIndex;
+using edjsamples::media_type::MediaType;
+using edjsamples::media_type::Route;
+using edjsamples::json::Validator;
 
 static const HttpStatusCode HTTP_STATUS_OK = 200;
 static const HttpStatusCode HTTP_STATUS_BAD_REQUEST = 400;
 static const HttpStatusCode HTTP_STATUS_METHOD_NOT_ALLOWED = 405;
+static const HttpStatusCode HTTP_STATUS_UNSUPPORTED_MEDIA_TYPE = 415;
+
+// This helper class inserts a "key":"value" pair at the beginning of a JSON
+// object that is sent chunk by chunk. It inserts the key:value pair after
+// the opening brace '{' of the object, with a comma ',' if the object is not
+// empty. Other JSON values (arrays, strings, ...) and everything after the
+// first member are written unchanged, so the body is never buffered.
+class JsonMemberInserter {
+public:
+    JsonMemberInserter(const std::string & name, const std::string & value)
+        : member("\"" + name + "\":\"" + value + "\"") {}
 
-// This helper function returns false if JSON is empty.
-// No further validation is performed.
-bool json_is_valid(const std::string & json) {
-    bool empty = true;
+    StreamError write_chunk(WriteStream & write_stream, std::vector<uint8_t> & chunk) {
+        size_t i = 0;
 
-    for (auto c : json) {
-        if (!isspace(c)) {
-            empty = false;
+        if (state == State::BeforeValue) {
+            while (i < chunk.size() && isspace(chunk[i])) {
+                i++;
+            }
+            if (i == chunk.size()) {
+                return write_stream.write_chunk(chunk);
+            }
+            if (chunk[i] != '{') {
+                state = State::PassThrough;
+                return write_stream.write_chunk(chunk);
+            }
+            i++;
+            std::string head(chunk.begin(), chunk.begin() + i);
+            StreamError err = write_stream.write_chunk(head + member);
+            if (err != StreamError::Success) {
+                return err;
+            }
+            state = State::AfterBrace;
+        }
+
+        if (state == State::AfterBrace) {
+            // Whitespace between '{' and the first member is dropped
+            while (i < chunk.size() && isspace(chunk[i])) {
+                i++;
+            }
+            if (i == chunk.size()) {
+                return StreamError::Success;
+            }
+            if (chunk[i] != '}') {
+                // The comma replaces the last byte that was already written or dropped
+                if (i > 0) {
+                    chunk[--i] = ',';
+                } else {
+                    chunk.insert(chunk.begin(), ',');
+                }
+            }
+            state = State::PassThrough;
+            // Moves the rest of the chunk to the front, no allocation
+            chunk.erase(chunk.begin(), chunk.begin() + i);
         }
+
+        return write_stream.write_chunk(chunk);
     }
 
-    return !empty;
+private:
+    enum class State {
+        BeforeValue,    // Only whitespace so far
+        AfterBrace,     // The key:value pair was inserted after '{'
+        PassThrough
+    };
+
+    std::string member;
+    State state = State::BeforeValue;
+};
+
+// Sends the status and headers of a streamed response
+static bool start_response(WriteStream & write_stream, const std::string & content_type) {
+    HttpResponse res;
+    res.set_status(HTTP_STATUS_OK)
+        .set_header("Serverless", "EDJX")
+        .set_header("Content-Type", content_type);
+    HttpError http_err = res.send_streaming(write_stream);
+    if (http_err != HttpError::Success) {
+        error("Could not open write stream: " + to_string(http_err));
+        return false;
+    }
+    return true;
 }
 
-// This helper function inserts a "key":"value" pair at the beginning of a JSON.
-// It looks for an opening brace '{' and inserts the key:value pair after it.
-// It will append a comma ',' after the key:value pair if needed.
-// This function does not attempt to validate the JSON.
-std::string insert_into_json(
-    const std::string & json,
-    const std::string & name,
-    const std::string & value
-) {
-    bool inserted = false;
-    bool comma_inserted = false;
-    bool comma_not_needed = false;
-
-    std::string result;
-
-    for (char c : json) {
-        if (c == '{' && !inserted) {
-            result += "{\"" + name + "\":\"" + value + "\"";
-            inserted = true;
-        } else if (inserted && !comma_inserted && !comma_not_needed) {
-            if (isspace(c)) {
-                continue;
-            } else if (c != '}') {
-                result += ',';
-                comma_inserted = true;
-            } else {
-                comma_not_needed = true;
-            }
-            result += c;
-        } else {
-            result += c;
-        }
+static bool send_response(HttpResponse & res) {
+    HttpError err = res.send();
+    if (err != HttpError::Success) {
+        error("Could not send the response: " + to_string(err));
+        return false;
     }
+    return true;
+}
 
-    return result;
+static bool send_bad_request(const std::string & message) {
+    error(message);
+    HttpResponse(message)
+        .set_status(HTTP_STATUS_BAD_REQUEST)
+        .set_header("Serverless", "EDJX")
+        .set_header("Content-Type", "text/plain")
+        .send();
+    return false;
 }
 
-// This helper function appends a Name=Value pair at the beginning of
-// a URL-encoded form. The appended Name=Value pair must already
-// be in an encoded form.
-std::string insert_into_form(
-    const std::string & form,
-    const std::string & name,
-    const std::string & value
-) {
-    std::string result = name + "=" + value;
+// Closes both streams at the end of a streamed response
+static bool close_streams(ReadStream & read_stream, WriteStream & write_stream) {
+    bool close_success = true;
 
-    bool form_empty = true;
-    for (char c : form) {
-        if (!isspace(c)) {
-            form_empty = false;
-            break;
-        }
+    StreamError close_err = write_stream.close();
+    if (close_err != StreamError::Success) {
+        error("Error when closing the write stream: " + to_string(close_err));
+        close_success = false;
     }
 
-    if (!form_empty) {
-        result += "&" + form;
+    close_err = read_stream.close();
+    if (close_err != StreamError::Success) {
+        error("Error when closing the read stream: " + to_string(close_err));
+        close_success = false;
     }
 
-    return result;
+    return close_success;
 }
 
-bool char_equal_nocase(char c1, char c2) {
-    return tolower(c1) == tolower(c2);
-}
+// Handlers of the supported request body media types
+typedef bool (*BodyHandler)(HttpRequest & req);
 
-bool string_equal_nocase(const std::string & str1, const std::string & str2) {
-    return str1.length() == str2.length() && std::equal(str1.begin(), str1.end(), str2.begin(), char_equal_nocase);
-}
+static bool handle_json(HttpRequest & req) {
+    ReadStream read_stream;
+    HttpError http_err = req.open_read_stream(read_stream);
+    if (http_err != HttpError::Success) {
+        return send_bad_request("Could not open read stream: " + to_string(http_err));
+    }
 
-// This helper function gets values of an HTTP header.
-std::optional<std::string> header_value(const HttpHeaders & headers, const std::string & name) {
-    std::optional<std::string> result = std::nullopt;
-    bool first_entry = true;
-
-    // Create a comma-separated list of all header values.
-    // Header name is case-insensitive.
-    for (const auto & header : headers) {
-        if (string_equal_nocase(header.first, name)) {
-            for (const std::string & value : header.second) {
-                if (first_entry) {
-                    result = "";
-                    first_entry = false;
-                } else {
-                    *result += ',';
-                }
-                *result += value;
+    // Every chunk is validated before it is sent. The response is started
+    // after the first valid chunk; if a later chunk is invalid, the response
+    // is aborted.
+    Validator validator;
+    JsonMemberInserter inserter("Modified By", "Example function");
+    WriteStream write_stream;
+    bool response_started = false;
+
+    std::vector<uint8_t> chunk;
+    StreamError read_err;
+    while ((read_err = read_stream.read_chunk(chunk)) == StreamError::Success) {
+        if (!validator.feed(chunk)) {
+            break;
+        }
+
+        if (!response_started) {
+            if (!start_response(write_stream, "application/json")) {
+                read_stream.close();
+                return false;
             }
+            response_started = true;
+        }
+
+        StreamError write_err = inserter.write_chunk(write_stream, chunk);
+        if (write_err != StreamError::Success) {
+            error("Error when writing a chunk: " + to_string(write_err));
+            read_stream.close();
+            write_stream.abort();
+            return false;
+        }
+    }
+
+    std::string message;
+    if (!validator.failed() && read_err != StreamError::EndOfStream) {
+        message = "Error when reading a chunk: " + to_string(read_err);
+    } else if (!validator.finish()) {
+        message = "Request body must be a valid JSON (error at byte " + std::to_string(validator.error_offset()) + ")";
+    }
+    if (!message.empty()) {
+        read_stream.close();
+        if (!response_started) {
+            return send_bad_request(message);
         }
+        error(message);
+        write_stream.abort();
+        return false;
     }
+    info(
+        "Valid JSON body: " + std::to_string(validator.size()) + " bytes, nesting depth "
+            + std::to_string(validator.max_depth())
+    );
 
-    return result;
+    return close_streams(read_stream, write_stream);
 }
 
-HttpResponse serverless(HttpRequest & req) {
-    info("**Incoming HTTP with diff content type function**");
+// The prefix is sent as its own chunk, then the request body is piped into
+// the response without being copied into the function's memory
+static bool handle_text(HttpRequest & req) {
+    ReadStream read_stream;
+    HttpError http_err = req.open_read_stream(read_stream);
+    if (http_err != HttpError::Success) {
+        return send_bad_request("Could not open read stream: " + to_string(http_err));
+    }
 
-    switch (req.get_method()) {
-        case HttpMethod::POST: {
-            std::string content_type_header = header_value(req.get_headers(), "Content-Type").value_or("");
-            std::vector<uint8_t> incoming_req_body;
-            HttpError err = req.read_body(incoming_req_body);
-            if (err != HttpError::Success) {
-                return HttpResponse(to_string(err))
-                    .set_status(HTTP_STATUS_BAD_REQUEST)
-                    .set_header("Serverless", "EDJX")
-                    .set_header("Content-Type", "text/plain");
-            }
+    WriteStream write_stream;
+    if (!start_response(write_stream, "text/plain")) {
+        read_stream.close();
+        return false;
+    }
 
-            if (content_type_header == "application/json") {
-                std::string body_str = edjx::utils::to_string(incoming_req_body);
+    StreamError write_err = write_stream.write_chunk("Modified By : Example Function ");
+    if (write_err != StreamError::Success) {
+        error("Error when writing a chunk: " + to_string(write_err));
+        read_stream.close();
+        write_stream.abort();
+        return false;
+    }
 
-                if (!json_is_valid(body_str)) {
-                    return HttpResponse("Request body must be a valid JSON")
-                        .set_status(HTTP_STATUS_BAD_REQUEST);
-                }
+    // pipe_to() closes both streams
+    StreamError pipe_err = read_stream.pipe_to(write_stream);
+    if (pipe_err != StreamError::Success) {
+        error("Error when piping the request body: " + to_string(pipe_err));
+        return false;
+    }
 
-                std::string outgoing_body = insert_into_json(body_str, "Modified By", "Example function");
+    return true;
+}
 
-                return HttpResponse(outgoing_body)
-                    .set_status(HTTP_STATUS_OK)
-                    .set_header("Serverless", "EDJX")
-                    .set_header("Content-Type", "application/json");
+// The Name=Value pair "Modified+By=Example+Function" is sent as its own
+// chunk before the form, followed by '&' if the form is not empty.
+// Chunks are written as they are received, so the form is never buffered;
+// they are not piped because their %XX escapes are checked on the way.
+static bool handle_form(HttpRequest & req) {
+    ReadStream read_stream;
+    HttpError http_err = req.open_read_stream(read_stream);
+    if (http_err != HttpError::Success) {
+        return send_bad_request("Could not open read stream: " + to_string(http_err));
+    }
+
+    edjsamples::percent::Validator validator;
+    WriteStream write_stream;
+    bool response_started = false;
+    bool form_empty = true;
+    bool form_valid = true;
+
+    std::vector<uint8_t> chunk;
+    StreamError read_err;
+    while ((read_err = read_stream.read_chunk(chunk)) == StreamError::Success) {
+        if (!validator.feed(chunk)) {
+            form_valid = false;
+            break;
+        }
+
+        if (!response_started) {
+            if (!start_response(write_stream, "application/x-www-form-urlencoded")) {
+                read_stream.close();
+                return false;
             }
-            else if (content_type_header == "text/plain") {
-                std::string body_str = edjx::utils::to_string(incoming_req_body);
+            response_started = true;
 
-                std::string outgoing_body = "Modified By : Example Function " + body_str;
+            StreamError write_err = write_stream.write_chunk("Modified+By=Example+Function");
+            if (write_err != StreamError::Success) {
+                error("Error when writing a chunk: " + to_string(write_err));
+                read_stream.close();
+                write_stream.abort();
+                return false;
+            }
+        }
 
-                return HttpResponse(outgoing_body)
-                    .set_status(HTTP_STATUS_OK)
-                    .set_header("Serverless", "EDJX")
-                    .set_header("Content-Type", "text/plain");
+        if (form_empty) {
+            // Leading whitespace is dropped; the first other byte decides
+            // that the form is not empty and is preceded by '&'
+            size_t i = 0;
+            while (i < chunk.size() && isspace(chunk[i])) {
+                i++;
             }
-            else if (content_type_header == "application/x-www-form-urlencoded") {
-                std::string body_str = edjx::utils::to_string(incoming_req_body);
-
-                std::string outgoing_body = insert_into_form(body_str, "Modified+By", "Example+Function");
-
-                return HttpResponse(outgoing_body)
-                    .set_status(HTTP_STATUS_OK)
-                    .set_header("Serverless", "EDJX")
-                    .set_header(
-                        "Content-Type",
-                        "application/x-www-form-urlencoded"
-                    );
+            if (i == chunk.size()) {
+                continue;
             }
-            else {
-                return HttpResponse().set_status(HTTP_STATUS_BAD_REQUEST);
+            form_empty = false;
+            if (i > 0) {
+                chunk[--i] = '&';
+                chunk.erase(chunk.begin(), chunk.begin() + i);
+            } else {
+                chunk.insert(chunk.begin(), '&');
             }
-            break;
+        }
+
+        StreamError write_err = write_stream.write_chunk(chunk);
+        if (write_err != StreamError::Success) {
+            error("Error when writing a chunk: " + to_string(write_err));
+            read_stream.close();
+            write_stream.abort();
+            return false;
+        }
+    }
+
+    std::string message;
+    if (form_valid && read_err != StreamError::EndOfStream) {
+        message = "Error when reading a chunk: " + to_string(read_err);
+    } else if (!form_valid || !validator.finish()) {
+        message = "Request body must be a valid URL-encoded form";
+    }
+    if (!message.empty()) {
+        read_stream.close();
+        if (!response_started) {
+            return send_bad_request(message);
+        }
+        error(message);
+        write_stream.abort();
+        return false;
+    }
+
+    if (!response_started) {
+        // Empty body
+        read_stream.close();
+        return send_response(
+            HttpResponse("Modified+By=Example+Function")
+                .set_status(HTTP_STATUS_OK)
+                .set_header("Serverless", "EDJX")
+                .set_header("Content-Type", "application/x-www-form-urlencoded")
+        );
+    }
+
+    return close_streams(read_stream, write_stream);
+}
+
+// Media type parameters (e.g., "; charset=utf-8") do not affect the dispatch
+static constexpr Route<BodyHandler> BODY_HANDLERS[] = {
+    {"application", "json", handle_json},
+    {"text", "plain", handle_text},
+    {"application", "x-www-form-urlencoded", handle_form},
+};
+
+bool serverless_streaming(HttpRequest & req) {
+    info("**Incoming HTTP with diff content type function**");
+
+    switch (req.get_method()) {
+        case HttpMethod::POST: {
+            const HttpHeaders & headers = req.get_headers();
+            HeaderIndex header_index(headers);
+
+            // Reject unsupported content types before the body is read
+            std::optional<MediaType> content_type = edjsamples::media_type::parse(
+                header_index.first("Content-Type").value_or("")
+            );
+            const Route<BodyHandler> * route = content_type.has_value()
+                ? edjsamples::media_type::find_route(BODY_HANDLERS, content_type.value())
+                : nullptr;
+            if (route == nullptr) {
+                HttpResponse().set_status(HTTP_STATUS_UNSUPPORTED_MEDIA_TYPE).send();
+                return false;
+            }
+
+            return route->handler(req);
         }
         default: {
-            return HttpResponse().set_status(HTTP_STATUS_METHOD_NOT_ALLOWED);
+            HttpResponse().set_status(HTTP_STATUS_METHOD_NOT_ALLOWED).send();
+            return false;
         }
     }
 }
\ No newline at end of file
@@ -17,7 +17,7 @@ static const HttpStatusCode HTTP_STATUS_BAD_REQUEST = 400;
 
 extern HttpResponse serverless(const HttpRequest & req);
 
-int main(void) {
+static int handle_request(void) {
     HttpRequest req;
     HttpError err = HttpRequest::from_client(req);
     if (err != HttpError::Success) {
@@ -36,6 +36,12 @@ int main(void) {
     return EXIT_SUCCESS;
 }
 
+int main(void) {
+    return handle_request();
+}
+
+#ifndef EDJX_PREINITIALIZED
+
 //
 // edjExecutor calls init() instead of _start()
 // (constructors of global objects are not called if _start() is not executed)
@@ -45,4 +51,33 @@ extern "C" void _start(void);
 __attribute__((export_name("init")))
 extern "C" void init(void) {
     _start();
-}
\ No newline at end of file
+}
+
+#else
+
+//
+// `make snapshot`: Wizer calls wizer.initialize() at build time and stores
+// the initialized linear memory in the module, so init() handles the request
+// without running constructors of global objects again
+// (calling __wasm_call_ctors() explicitly also stops wasm-ld from wrapping
+// the exported functions with constructor calls)
+//
+extern "C" void __wasm_call_ctors(void);
+extern "C" void __wasm_call_dtors(void);
+
+__attribute__((export_name("wizer.initialize")))
+extern "C" void wizer_initialize(void) {
+    __wasm_call_ctors();
+}
+
+__attribute__((export_name("init")))
+extern "C" void init(void) {
+    int status = handle_request();
+    // Same as the end of _start(): run destructors (flushes stdio) and exit
+    __wasm_call_dtors();
+    if (status != EXIT_SUCCESS) {
+        _Exit(status);
+    }
+}
+
+#endif
\ No newline at end of file
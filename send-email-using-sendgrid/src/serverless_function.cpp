@@ -10,6 +10,8 @@
 #include <edjx/error.hpp>
 #include <edjx/utils.hpp>
 
+#include <edjsamples/query.hpp>
+
 using edjx::logger::info;
 using edjx::logger::error;
 using edjx::http::HttpMethod;
@@ -21,6 +23,7 @@ using edjx::fetch::HttpFetch;
 using edjx::fetch::FetchResponse;
 using edjx::error::HttpError;
 using edjx::error::StreamError;
+using edjsamples::query::QueryParams;
 
 static const HttpStatusCode HTTP_STATUS_BAD_REQUEST = 400;
 
@@ -42,62 +45,15 @@ HttpError send_email(FetchResponse & response, const std::string & subject, cons
         .send(response);
 }
 
-std::optional<std::string> query_param_by_name(const HttpRequest & req, const std::string & param_name) {
-    std::string uri = req.get_uri().as_string();
-    std::vector<std::pair<std::string, std::string>> query_parsed;
-
-    // e.g., https://example.com/path/to/page?name=ferret&color=purple
-
-    size_t query_start = uri.find('?');
-
-    if (query_start != std::string::npos) {
-        // Query is present
-        std::string name;
-        std::string value;
-        bool parsing_name = true;
-        for (std::string::iterator it = uri.begin() + query_start + 1; it != uri.end(); ++it) {
-            char c = *it;
-            switch (c) {
-                case '?':
-                    break; // Invalid URI
-                case '=':
-                    parsing_name = false;
-                    break;
-                case '&':
-                    query_parsed.push_back(make_pair(name, value));
-                    name.clear();
-                    value.clear();
-                    parsing_name = true;
-                    break;
-                default:
-                    if (parsing_name) {
-                        name += c;
-                    } else {
-                        value += c;
-                    }
-                    break;
-            }
-        }
-        if (!name.empty() || !value.empty()) {
-            query_parsed.push_back(make_pair(name, value));
-        }
-
-        for (const auto & parameter : query_parsed) {
-            if (parameter.first == param_name) {
-                return parameter.second;
-            }
-        }
-    }
-
-    return {};
-}
-
 HttpResponse serverless(const HttpRequest & req) {
     info("**Send email using sendgrid function**");
 
-    std::string message = query_param_by_name(req, "message").value_or("Default Message");
+    std::string uri = req.get_uri().as_string();
+    QueryParams query(uri);
+
+    std::string message = query.get_decoded("message").value_or("Default Message");
 
-    std::string subject = query_param_by_name(req, "subject").value_or("Default Subject");
+    std::string subject = query.get_decoded("subject").value_or("Default Subject");
 
     FetchResponse fetch_response;
     HttpError err = send_email(fetch_response, subject, message);